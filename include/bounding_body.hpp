@@ -19,6 +19,11 @@ struct Circle {
     bool contains(const sf::Vector2<T>& point) const;
     bool contains(T x, T y) const;
 
+    //moving the circle from its center to end (swept circle)
+    //t is the fraction of the movement until the first contact (0 if they already intersect)
+    bool sweepIntersects(const sf::Vector2<T>& end, const Circle<T>& other, T& t) const;
+    bool sweepIntersects(const sf::Vector2<T>& end, const sf::Rect<T>& rect, T& t) const;
+
     sf::Vector2<T> center;
     T radius;
 };
@@ -1,5 +1,7 @@
 #include "bounding_body.hpp"
 
+#include <cmath>
+#include <algorithm>
 #include <SFML/Graphics/Transform.hpp>
 #include "helper.hpp"
 
@@ -348,6 +350,89 @@ bool Circle<T>::contains(T x, T y) const
     return contains(sf::Vector2<T>(x, y));
 }
 
+template<typename T>
+bool Circle<T>::sweepIntersects(const sf::Vector2<T>& end, const Circle<T>& other, T& t) const
+{
+    if (intersects(other)) {
+        t = 0;
+        return true;
+    }
+
+    //|center + movement * t - other.center| = radius + other.radius
+    const sf::Vector2<T> movement = end - center;
+    const sf::Vector2<T> offset = center - other.center;
+    const T radiusSum = radius + other.radius;
+
+    const T a = movement.x * movement.x + movement.y * movement.y;
+    const T b = offset.x * movement.x + offset.y * movement.y;
+    const T c = offset.x * offset.x + offset.y * offset.y - radiusSum * radiusSum;
+
+    //not moving or moving away
+    if (a == 0 || b >= 0) return false;
+
+    const T discriminant = b * b - a * c;
+
+    if (discriminant < 0) return false;
+
+    t = (-b - std::sqrt(discriminant))/a;
+
+    return t <= 1;
+}
+
+template<typename T>
+bool Circle<T>::sweepIntersects(const sf::Vector2<T>& end, const sf::Rect<T>& rect, T& t) const
+{
+    if (intersects(rect)) {
+        t = 0;
+        return true;
+    }
+
+    const sf::Vector2<T> movement = end - center;
+
+    //the center has to enter the rect grown by the radius (with rounded corners)
+    const T start[2] = {center.x, center.y};
+    const T direction[2] = {movement.x, movement.y};
+    const T min[2] = {rect.left - radius, rect.top - radius};
+    const T max[2] = {rect.left + rect.width + radius, rect.top + rect.height + radius};
+
+    T enterTime = 0;
+    T exitTime = 1;
+
+    for (int i = 0; i < 2; ++i) {
+        if (direction[i] == 0) {
+            if (start[i] < min[i] || start[i] > max[i]) return false;
+            continue;
+        }
+
+        T time1 = (min[i] - start[i])/direction[i];
+        T time2 = (max[i] - start[i])/direction[i];
+
+        if (time1 > time2) std::swap(time1, time2);
+
+        enterTime = std::max(enterTime, time1);
+        exitTime = std::min(exitTime, time2);
+
+        if (enterTime > exitTime) return false;
+    }
+
+    const sf::Vector2<T> point = center + movement * enterTime;
+
+    const bool outsideX = point.x < rect.left || point.x > rect.left + rect.width;
+    const bool outsideY = point.y < rect.top || point.y > rect.top + rect.height;
+
+    //entering through a corner, so it has to hit the rounded part
+    if (outsideX && outsideY) {
+        const sf::Vector2<T> corner(point.x < rect.left ? rect.left : rect.left + rect.width,
+                                    point.y < rect.top ? rect.top : rect.top + rect.height);
+
+        return sweepIntersects(end, Circle<T>(corner, 0), t);
+    }
+
+    t = enterTime;
+
+    return true;
+}
+
 template <typename T>
 BoundingBody<T>::BoundingBody() :
     BoundingBody(RotatingRect<T>())
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "bounding_body.hpp"
+
+class Entity;
+class CollisionManager;
+
+//inclusive range of cells of the uniform grid
+struct GridCellRange {
+    int left;
+    int top;
+    int right;
+    int bottom;
+};
+
+//Entry of an entity in the broadphase (embedded in the entity itself)
+//Queries give back proxies, so candidates can be filtered by team or solidity
+//without looking up the entity in the entity table
+//Entities remove their proxy when they're destroyed, so entity is always valid inside a query
+struct BroadphaseProxy {
+    BroadphaseProxy() = default;
+
+    //a copy of an entity is not in the broadphase
+    BroadphaseProxy(const BroadphaseProxy&) {}
+    BroadphaseProxy& operator=(const BroadphaseProxy&) {return *this;}
+
+    Entity* entity = nullptr;
+    u32 uniqueId = 0;
+    u8 teamId = 0;
+    bool solid = false;
+
+    BoundingBodyf body;
+
+    //nullptr if it's not in a broadphase
+    CollisionManager* collisionManager = nullptr;
+
+    //position in the proxy list of the collision manager
+    size_t index = 0;
+
+    //cells it's in when the uniform grid is used
+    GridCellRange gridCells;
+};
+
+class BroadphaseProxyExtractor {
+public:
+    static void ExtractBoundingBody(const BroadphaseProxy* in, BoundingBodyf* out);
+};
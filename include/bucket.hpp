@@ -1,15 +1,17 @@
 #pragma once
 
 #include <vector>
-#include <unordered_map>
 
 #include "defines.hpp"
+#include "flat_index.hpp"
+#include "memory_stats.hpp"
 
 //This is called bucket for lack of a better term
 
 //Container that keeps data tight in memory
-//Uses a hash table to access data by a unique identifier
-//This uniqueId has to be handled somewhere else
+//Uses a flat hash table to access data by a unique identifier
+//(it has no pointers, so copying the bucket is just copying two arrays)
+//This uniqueId has to be handled somewhere else (and 0 is not valid)
 
 template<typename T>
 class Bucket
@@ -44,8 +46,8 @@ public:
     void clear();
 
 private:
-    std::vector<T> m_elements;
-    std::unordered_map<u32, int> m_hashTable;
+    std::vector<T, TrackedAllocator<T, MEMORY_TAG_BUCKETS>> m_elements;
+    FlatIndex m_index;
 
     int m_firstInvalidIndex;
 };
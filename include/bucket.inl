@@ -1,6 +1,7 @@
 #include "bucket.hpp"
 
 #include <iostream>
+#include <algorithm>
 
 template<typename T>
 Bucket<T>::Bucket(int initialSize)
@@ -21,8 +22,8 @@ void Bucket<T>::resize(int size)
 template<typename T>
 int Bucket<T>::addElement(u32 uniqueId)
 {
-    if (m_hashTable.find(uniqueId) != m_hashTable.end()) {
-        std::cout << "Bucket::addElement error - UniqueId already exists" << std::endl;
+    if (uniqueId == 0 || m_index.find(uniqueId)) {
+        std::cout << "Bucket::addElement error - Invalid or repeated uniqueId" << std::endl;
         return -1;
     }
 
@@ -33,7 +34,7 @@ int Bucket<T>::addElement(u32 uniqueId)
     }
 
     int index = m_firstInvalidIndex++;
-    m_hashTable.emplace(uniqueId, index);
+    m_index.insert(uniqueId, index);
 
     return index;
 }
@@ -47,11 +48,11 @@ void Bucket<T>::removeElement(u32 uniqueId)
         m_firstInvalidIndex--;
 
         if (index != m_firstInvalidIndex) {            
-            m_hashTable[m_elements[m_firstInvalidIndex].uniqueId] = index;
+            *m_index.find(m_elements[m_firstInvalidIndex].uniqueId) = index;
             m_elements[index] = std::move(m_elements[m_firstInvalidIndex]);
         }
 
-        m_hashTable.erase(uniqueId);
+        m_index.erase(uniqueId);
 
     } else {
         std::cout << "Bucket::removeElement error - UniqueId doesn't exist" << std::endl;
@@ -61,20 +62,16 @@ void Bucket<T>::removeElement(u32 uniqueId)
 template<typename T>
 void Bucket<T>::copyValidDataTo(Bucket<T>& otherBucket) const
 {
-    if (m_firstInvalidIndex == 0) return;
-
-    //clear containers
     otherBucket.m_firstInvalidIndex = m_firstInvalidIndex;
-    otherBucket.m_hashTable.clear();
+
+    //the index is copied as it is instead of inserting every element again
+    otherBucket.m_index = m_index;
 
     if (otherBucket.m_elements.size() < m_firstInvalidIndex) {
         otherBucket.resize(m_firstInvalidIndex);
     }
 
-    for (int i = 0; i < m_firstInvalidIndex; ++i) {
-        otherBucket.m_elements[i] = m_elements[i];
-        otherBucket.m_hashTable.emplace(m_elements[i].uniqueId, i);
-    }
+    std::copy(m_elements.begin(), m_elements.begin() + m_firstInvalidIndex, otherBucket.m_elements.begin());
 }
 
 template<typename T>
@@ -110,9 +107,9 @@ const T& Bucket<T>::operator[](int index) const
 template<typename T>
 int Bucket<T>::getIndexByUniqueId(u32 uniqueId) const
 {
-    auto it = m_hashTable.find(uniqueId);
-    if (it != m_hashTable.end()) {
-        return it->second;
+    const u32* index = m_index.find(uniqueId);
+    if (index) {
+        return *index;
     }
 
     return -1;
@@ -158,5 +155,5 @@ template<typename T>
 void Bucket<T>::clear()
 {
     m_firstInvalidIndex = 0;
-    m_hashTable.clear();
+    m_index.clear();
 }
@@ -18,6 +18,25 @@ enum BuffType {
     BUFF_MAX_TYPES
 };
 
+//callbacks each buff type overrides (BuffHolderComponent only calls those)
+enum BuffCallback {
+    BUFF_CALLBACK_PRE_UPDATE                = 1 << 0,
+    BUFF_CALLBACK_UPDATE                    = 1 << 1,
+    BUFF_CALLBACK_DEATH                     = 1 << 2,
+    BUFF_CALLBACK_TAKE_DAMAGE               = 1 << 3,
+    BUFF_CALLBACK_PROJECTILE_HIT            = 1 << 4,
+    BUFF_CALLBACK_DEAL_DAMAGE               = 1 << 5,
+    BUFF_CALLBACK_BE_HEALED                 = 1 << 6,
+    BUFF_CALLBACK_HEAL                      = 1 << 7,
+    BUFF_CALLBACK_ENTITY_KILL               = 1 << 8,
+    BUFF_CALLBACK_GET_DAMAGE_MULTIPLIER     = 1 << 9,
+    BUFF_CALLBACK_MOVEMENT                  = 1 << 10,
+    BUFF_CALLBACK_PRIMARY_FIRE_CASTED       = 1 << 11,
+    BUFF_CALLBACK_SECONDARY_FIRE_CASTED     = 1 << 12,
+    BUFF_CALLBACK_ALT_ABILITY_CASTED        = 1 << 13,
+    BUFF_CALLBACK_ULTIMATE_CASTED           = 1 << 14
+};
+
 class Entity;
 class Unit;
 class Ability;
@@ -29,6 +48,11 @@ public:
     static u8 stringToType(const std::string& typeStr);
 
     virtual Buff* clone() const = 0;
+    virtual ~Buff() = default;
+
+    //memory comes from a pool shared by all buff types (they're added and removed very often)
+    static void* operator new(std::size_t size);
+    static void operator delete(void* ptr, std::size_t size);
 
     virtual void loadFromJson(const rapidjson::Document& doc);
     
@@ -67,6 +91,9 @@ public:
 
     void setUnit(Unit* unit);
 
+    //called when the unit holding the buff is copied (the buff already has the new unit)
+    virtual void onUnitCopied(const Unit& prevUnit);
+
     void kill();
     bool isDead() const;
     
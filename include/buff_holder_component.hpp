@@ -1,6 +1,7 @@
 #pragma once
 
-#include <list>
+#include <vector>
+#include <memory>
 #include "component.hpp"
 #include "buff.hpp"
 
@@ -27,8 +28,19 @@ public:
     void removeUniqueBuff(u8 buffType);
 
 protected:
-    std::list<std::unique_ptr<Buff>> m_buffs;
-    
+    struct BuffSlot {
+        std::unique_ptr<Buff> buff;
+
+        //callbacks overriden by the buff type (see BuffCallback)
+        u16 callbacks;
+    };
+
+    //contiguous, so callbacks only visit an array of a few slots
+    std::vector<BuffSlot> m_buffs;
+
+    //callbacks overriden by any of the buffs (events nobody listens to return right away)
+    u16 m_callbacks = 0;
+
 public:
     //there are more callbacks that don't get called at the same time for all the buffs
     //onEnd() onStart() onPurged()
@@ -53,7 +65,12 @@ protected:
     void onDealDamage(u16 damage, Entity* target);
 
 private:
+    Buff* _insertBuff(Buff* buff);
+    void _copyBuffs(const BuffHolderComponent& other);
+    void _updateCallbacks();
+
     static std::unique_ptr<Buff> m_buffData[BUFF_MAX_TYPES];
+    static u16 m_buffCallbacks[BUFF_MAX_TYPES];
     static bool m_buffsLoaded;
 };
 
@@ -17,6 +17,8 @@ public:
 
     void setParentAbility(RechargeAbility* ability, const ManagersContext& context);
 
+    void onUnitCopied(const Unit& prevUnit);
+
 private:
     float getMultiplier() const;
 
@@ -1,31 +1,88 @@
 #pragma once
 
 #include <memory>
-#include <unordered_map>
+#include <vector>
 
-#include "quadtree_entity.hpp"
+#include "json_parser.hpp"
+#include "broadphase_proxy.hpp"
 #include "quadtree.hpp"
+#include "uniform_grid.hpp"
 
-using QuadtreeType = Quadtree<float, QuadtreeEntityType, SimpleExtractor<float>>;
+using QuadtreeType = Quadtree<float, BroadphaseProxy, BroadphaseProxyExtractor>;
+
+enum BroadphaseType {
+    BROADPHASE_QUADTREE,
+    BROADPHASE_UNIFORM_GRID
+};
+
+class Entity;
 
 class CollisionManager
 {
 public:
-    CollisionManager();
+    CollisionManager(BroadphaseType broadphaseType = BROADPHASE_QUADTREE);
     ~CollisionManager();
 
     CollisionManager(const CollisionManager&) = delete;
     CollisionManager& operator=(const CollisionManager&) = delete;
 
-    void onInsertEntity(u32 uniqueId, const Vector2& pos, u8 radius);
-    void onUpdateEntity(u32 uniqueId, const Vector2& newPos, float newRadius);
-    void onDeleteEntity(u32 uniqueId);
-    
-    void clear();
+    //the broadphase can only be changed while it's empty
+    void loadFromJson(const rapidjson::Document& doc);
+    void setBroadphaseType(BroadphaseType broadphaseType, float cellSize = DEFAULT_GRID_CELL_SIZE);
+    BroadphaseType getBroadphaseType() const;
+
+    //has to be called every time a new map is loaded (used by the uniform grid)
+    void setWorldSize(const Vector2u& worldSize);
+
+    //uses the proxy embedded in the entity
+    void onInsertEntity(Entity* entity);
+    void onUpdateEntity(Entity* entity);
+    void onDeleteEntity(Entity* entity);
+
+    //the body of the proxy has to be set before inserting or updating it
+    void insertProxy(BroadphaseProxy* proxy);
+    void updateProxy(BroadphaseProxy* proxy);
+    void removeProxy(BroadphaseProxy* proxy);
+
+    //visitor(const BroadphaseProxy& proxy) is called for each entity that intersects the region
+    //it returns true to stop the query (most queries only need the first hit)
+    template<typename Visitor>
+    void forEachIntersecting(const BoundingBodyf& region, Visitor visitor);
+
+    size_t getSize() const;
+    const std::vector<BroadphaseProxy*>& getProxies() const;
 
-    QuadtreeType* getQuadtree();
+    //changes every time a proxy is inserted, updated or removed
+    //(used to know if the results of previous queries are still valid)
+    u32 getChangeCount() const;
+
+    //proxies are detached from the manager
+    void clear();
 
 private:
+    BroadphaseType m_broadphaseType;
+
     std::unique_ptr<QuadtreeType> m_quadtree;
-    std::unordered_map<u32, std::unique_ptr<QuadtreeEntityType>> m_entities;
+
+    //proxies know their index (swap and pop on removal)
+    std::vector<BroadphaseProxy*> m_proxies;
+
+    Vector2u m_worldSize;
+    UniformGrid m_grid;
+
+    u32 m_changeCount;
 };
+
+template<typename Visitor>
+void CollisionManager::forEachIntersecting(const BoundingBodyf& region, Visitor visitor)
+{
+    auto proxyVisitor = [&visitor] (BroadphaseProxy* proxy) -> bool {
+        return visitor(*proxy);
+    };
+
+    if (m_broadphaseType == BROADPHASE_UNIFORM_GRID) {
+        m_grid.forEachIntersecting(region, proxyVisitor);
+    } else {
+        m_quadtree->ForEachIntersecting(region, proxyVisitor);
+    }
+}
@@ -11,10 +11,15 @@ public:
 
     virtual void loadFromJson(const rapidjson::Document& doc);
 
+    static constexpr u8 UPDATE_HOOKS = ENTITY_HOOK_UPDATE | ENTITY_HOOK_POST_UPDATE;
+
+    typedef CrateNetState NetState;
+
     virtual void update(sf::Time eTime, const ManagersContext& context);
     virtual void preUpdate(sf::Time eTime, const ManagersContext& context);
     virtual void postUpdate(sf::Time eTime, const ManagersContext& context);
-    virtual void packData(const Entity* prevEntity, u8 teamId, u32 controlledEntityUniqueId, CRCPacket& outPacket) const;
+    virtual void packData(const EntityNetState* prevState, u8 teamId, const Vector2u& worldSize, CRCPacket& outPacket) const;
+    virtual void takeNetState(EntityNetState& state) const;
 
     virtual void onCreated();
     virtual void onDeath(bool& dead, const ManagersContext& context);
@@ -39,7 +44,7 @@ public:
     virtual void loadFromJson(const rapidjson::Document& doc, u16 textureId, const Context& context);
 
     virtual void update(sf::Time eTime, const C_ManagersContext& context);
-    virtual void loadFromData(u32 controlledEntityUniqueId, CRCPacket& inPacket, CasterSnapshot& casterSnapshot);
+    virtual void loadFromData(const Vector2u& worldSize, CRCPacket& inPacket, CasterSnapshot& casterSnapshot);
     virtual void interpolate(const C_Entity* prevEntity, const C_Entity* nextEntity, double t, double d, bool isControlled);
     virtual void copySnapshotData(const C_Entity* snapshotEntity, bool isControlled);
 
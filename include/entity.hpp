@@ -10,6 +10,9 @@
 #include "component.hpp"
 #include "caster_snapshot.hpp"
 #include "render_node.hpp"
+#include "net_state.hpp"
+#include "quantize.hpp"
+#include "broadphase_proxy.hpp"
 
 class BaseEntityComponent
 {
@@ -42,6 +45,9 @@ public:
 
     bool canCollide(const BaseEntityComponent& otherEntity) const;
 
+    //world units of each step when positions are sent
+    float getPositionPrecision() const;
+
 protected:
     void loadFromJson(const rapidjson::Document& doc);
 
@@ -56,6 +62,8 @@ protected:
     u8 m_flyingHeight;
     bool m_inBush;
     bool m_solid;
+
+    float m_positionPrecision;
 };
 
 enum EntityType {
@@ -67,21 +75,53 @@ enum EntityType {
     ENTITY_MAX_TYPES
 };
 
+//update hooks implemented by each entity type
+//(EntityManager doesn't call the ones an entity type leaves empty)
+enum EntityUpdateHook {
+    ENTITY_HOOK_PRE_UPDATE  = 1 << 0,
+    ENTITY_HOOK_UPDATE      = 1 << 1,
+    ENTITY_HOOK_POST_UPDATE = 1 << 2,
+
+    ENTITY_HOOK_ALL = ENTITY_HOOK_PRE_UPDATE | ENTITY_HOOK_UPDATE | ENTITY_HOOK_POST_UPDATE
+};
+
 class Entity : public BaseEntityComponent
 {
 public:
     virtual Entity* clone() const = 0;
 
+    //memory comes from the pool of the entity type (clone uses new (m_type))
+    static void* operator new(std::size_t size);
+    static void* operator new(std::size_t size, u8 entityType);
+    static void operator delete(void* ptr);
+    static void operator delete(void* ptr, u8 entityType);
+
     //virtual destructor is required to delete an instance of a derived class through a pointer to this class
     //(even if delete is handled by unique_ptr)
-    virtual ~Entity() = default;
+    //it also removes the entity from the broadphase
+    virtual ~Entity();
 
     virtual void loadFromJson(const rapidjson::Document& doc);
 
+    //derived classes have to redefine this if some of their hooks are empty
+    static constexpr u8 UPDATE_HOOKS = ENTITY_HOOK_ALL;
+
     virtual void update(sf::Time eTime, const ManagersContext& context) = 0;
     virtual void preUpdate(sf::Time eTime, const ManagersContext& context) = 0;
     virtual void postUpdate(sf::Time eTime, const ManagersContext& context) = 0;
-    virtual void packData(const Entity* prevEntity, u8 teamId, u32 controlledEntityUniqueId, CRCPacket& outPacket) const = 0;
+    virtual void packData(const EntityNetState* prevState, u8 teamId, const Vector2u& worldSize, CRCPacket& outPacket) const = 0;
+
+    //data packData compares against, derived classes that send more data redefine it
+    //(prevState always points to the NetState of the entity type)
+    typedef EntityNetState NetState;
+
+    //stores the data packData compares against (used by snapshots)
+    //state has to be the NetState of the entity type
+    virtual void takeNetState(EntityNetState& state) const;
+
+    //data only sent to the client controlling this entity
+    //(packed separately so the rest of the snapshot can be shared between clients)
+    virtual void packControlledData(CRCPacket& outPacket) const;
 
     virtual void onCreated();
 
@@ -94,8 +134,17 @@ public:
 
     bool isDead() const;
 
+    //these also update the flags of the broadphase proxy
+    void setTeamId(u8 teamId);
+    void setSolid(bool solid);
+
+    BroadphaseProxy* getBroadphaseProxy();
+
 protected:
     bool m_dead;
+
+private:
+    BroadphaseProxy m_broadphaseProxy;
 };
 
 class C_Entity : public BaseEntityComponent
@@ -103,6 +152,12 @@ class C_Entity : public BaseEntityComponent
 public:
     virtual C_Entity* clone() const = 0;
 
+    //memory comes from the pool of the entity type (clone uses new (m_type))
+    static void* operator new(std::size_t size);
+    static void* operator new(std::size_t size, u8 entityType);
+    static void operator delete(void* ptr);
+    static void operator delete(void* ptr, u8 entityType);
+
     //virtual destructor is required to delete an instance of a derived class through a pointer to this class
     //(even if delete is handled by unique_ptr)
     virtual ~C_Entity() = default;
@@ -110,7 +165,8 @@ public:
     virtual void loadFromJson(const rapidjson::Document& doc, u16 textureId, const Context& context);
 
     virtual void update(sf::Time eTime, const C_ManagersContext& context) = 0;
-    virtual void loadFromData(u32 controlledEntityUniqueId, CRCPacket& inPacket, CasterSnapshot& casterSnapshot) = 0;
+    virtual void loadFromData(const Vector2u& worldSize, CRCPacket& inPacket, CasterSnapshot& casterSnapshot) = 0;
+    virtual void loadControlledData(CRCPacket& inPacket, CasterSnapshot& casterSnapshot);
     virtual void interpolate(const C_Entity* prevEntity, const C_Entity* nextEntity, double t, double d, bool isControlled) = 0;
     
     //Setup for the next interpolation
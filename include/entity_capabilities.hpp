@@ -0,0 +1,65 @@
+#pragma once
+
+#include <type_traits>
+
+#include "entity.hpp"
+#include "unit.hpp"
+#include "hero.hpp"
+
+//all entities have to be included
+#include "entities/food.hpp"
+#include "entities/crate.hpp"
+
+//Components of each entity type, generated at compile time from the classes in entities.inc
+//The accessors switch on the type of the entity and then use static_cast,
+//so they can be used instead of dynamic_cast in hot loops
+//(the same component can be reached through different classes, like HealthComponent
+//in Unit and Crate, so each type casts through its own class)
+
+template<typename Component, typename T>
+typename std::enable_if<std::is_base_of<Component, T>::value, Component*>::type
+_EntityCapabilities_cast(T* entity)
+{
+    return entity;
+}
+
+template<typename Component, typename T>
+typename std::enable_if<!std::is_base_of<Component, T>::value, Component*>::type
+_EntityCapabilities_cast(T*)
+{
+    return nullptr;
+}
+
+//Component can be a component or a class derived from Entity
+//(nullptr if the entity is nullptr or its type doesn't have it, same as dynamic_cast)
+template<typename Component>
+Component* Entity_getComponent(Entity* entity)
+{
+    if (!entity) return nullptr;
+
+    switch (entity->getEntityType()) {
+        #define DoEntity(class_name, type, json_id) \
+            case ENTITY_##type: return _EntityCapabilities_cast<Component>(static_cast<class_name*>(entity));
+        #include "entities.inc"
+        #undef DoEntity
+
+        default:
+            return nullptr;
+    }
+}
+
+template<typename Component>
+Component* C_Entity_getComponent(C_Entity* entity)
+{
+    if (!entity) return nullptr;
+
+    switch (entity->getEntityType()) {
+        #define DoEntity(class_name, type, json_id) \
+            case ENTITY_##type: return _EntityCapabilities_cast<Component>(static_cast<C_##class_name*>(entity));
+        #include "entities.inc"
+        #undef DoEntity
+
+        default:
+            return nullptr;
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+
+#include "defines.hpp"
+
+//Memory of entities is reused instead of going through the global heap every time one is cloned
+//There's one pool per entity type (see entities.inc) for server entities and another one for client entities
+//Pools are not thread safe (server and client entities are only created in their own thread)
+//(buffs also use an EntityPool, see buff.cpp)
+
+class EntityPool
+{
+public:
+    struct Stats {
+        size_t live = 0;
+        size_t free = 0;
+        size_t peak = 0;
+    };
+
+public:
+    EntityPool();
+    ~EntityPool();
+
+    //has to be called before allocating
+    void setBlockSize(size_t blockSize);
+    size_t getBlockSize() const;
+
+    void* allocate();
+    void deallocate(void* block);
+
+    const Stats& getStats() const;
+
+private:
+    //blocks are allocated in chunks of this many blocks
+    static constexpr size_t BLOCKS_PER_CHUNK = 32;
+
+    size_t m_blockSize;
+
+    std::vector<std::unique_ptr<char[]>> m_chunks;
+    std::vector<void*> m_freeBlocks;
+
+    Stats m_stats;
+};
+
+//memory for an entity of the given type (it falls back to the heap if the type has no pool
+//or if the object is bigger than the pool blocks, for example in classes not in entities.inc)
+void* EntityPool_allocate(bool client, u8 entityType, size_t size);
+void EntityPool_deallocate(void* ptr);
+
+const EntityPool::Stats& EntityPool_getStats(bool client, u8 entityType);
+void EntityPool_printStats(bool client);
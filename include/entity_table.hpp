@@ -1,70 +1,100 @@
 #pragma once
 
-#include <unordered_map>
+#include <vector>
 #include <memory>
 
+#include "flat_index.hpp"
+
+//Slot map of entities
+//Entities are stored in a dense array (removing one moves the last entity to its place),
+//so iterating doesn't chase hash nodes. Each entity also has a slot with a generation,
+//which gives handles that can be resolved without any lookup and that become
+//invalid when the entity is removed (even if the slot is reused).
+
+struct EntityHandle {
+    u32 slot = 0;
+
+    //0 is never a valid generation
+    u32 generation = 0;
+
+    bool operator==(const EntityHandle& other) const {return slot == other.slot && generation == other.generation;}
+    bool operator!=(const EntityHandle& other) const {return !(*this == other);}
+};
+
 template<typename _Entity_Type>
 class EntityTable
 {
 private:
-    typedef std::unordered_map<u32, std::unique_ptr<_Entity_Type>> _Table;
+    typedef std::vector<std::unique_ptr<_Entity_Type>> _Dense;
 
 public:
-    //These custom iterators return second element of pair when referenced
-    //which is very useful
+    //These custom iterators return the entity when referenced
+    //(they store an index, so adding entities while iterating is safe)
     class iterator
     {
     private:
         friend class EntityTable<_Entity_Type>;
-        typename _Table::iterator _internal_it;
+        _Dense* _dense;
+        size_t _index;
 
     public:
-        iterator() {}
-        iterator(typename _Table::iterator _it) : _internal_it(_it)  {}
+        iterator() : _dense(nullptr), _index(0) {}
+        iterator(_Dense* _d, size_t _i) : _dense(_d), _index(_i) {}
 
-        _Entity_Type& operator*()  const {return *_internal_it->second.get();}
-        _Entity_Type* operator->() const {return _internal_it->second.get();}
-        _Entity_Type* operator&()  const {return _internal_it->second.get();}
+        _Entity_Type& operator*()  const {return *(*_dense)[_index].get();}
+        _Entity_Type* operator->() const {return (*_dense)[_index].get();}
+        _Entity_Type* operator&()  const {return (*_dense)[_index].get();}
 
-        bool operator==(const iterator& rhs) const {return _internal_it == rhs._internal_it;}
-        bool operator!=(const iterator& rhs) const {return _internal_it != rhs._internal_it;}
+        bool operator==(const iterator& rhs) const {return _index == rhs._index;}
+        bool operator!=(const iterator& rhs) const {return _index != rhs._index;}
 
-        iterator& operator++()   {++_internal_it; return *this;}
-        iterator operator++(int) {iterator _copy_it(_internal_it); ++(*this); return _copy_it;}
+        iterator& operator++()   {++_index; return *this;}
+        iterator operator++(int) {iterator _copy_it(*this); ++(*this); return _copy_it;}
 
-        iterator& operator--()   {--_internal_it; return *this;}
-        iterator operator--(int) {iterator _copy_it(_internal_it); --(*this); return _copy_it;}
+        iterator& operator--()   {--_index; return *this;}
+        iterator operator--(int) {iterator _copy_it(*this); --(*this); return _copy_it;}
     };
 
     class const_iterator
     {
     private:
         friend class EntityTable<_Entity_Type>;
-        typename _Table::const_iterator _internal_it;
+        const _Dense* _dense;
+        size_t _index;
+
     public:
-        const_iterator() {}
-        const_iterator(const typename _Table::const_iterator& _it) : _internal_it(_it) {}
+        const_iterator() : _dense(nullptr), _index(0) {}
+        const_iterator(const _Dense* _d, size_t _i) : _dense(_d), _index(_i) {}
 
-        const _Entity_Type& operator*()  const {return *_internal_it->second.get();}
-        const _Entity_Type* operator->() const {return _internal_it->second.get();}
-        const _Entity_Type* operator&()  const {return _internal_it->second.get();}
+        const _Entity_Type& operator*()  const {return *(*_dense)[_index].get();}
+        const _Entity_Type* operator->() const {return (*_dense)[_index].get();}
+        const _Entity_Type* operator&()  const {return (*_dense)[_index].get();}
 
-        bool operator==(const const_iterator& rhs) const {return _internal_it == rhs._internal_it;}
-        bool operator!=(const const_iterator& rhs) const {return _internal_it != rhs._internal_it;}
+        bool operator==(const const_iterator& rhs) const {return _index == rhs._index;}
+        bool operator!=(const const_iterator& rhs) const {return _index != rhs._index;}
 
-        const_iterator& operator++()   {++_internal_it; return *this;}
-        const_iterator operator++(int) {const_iterator _copy_it(_internal_it); ++(*this); return _copy_it;}
+        const_iterator& operator++()   {++_index; return *this;}
+        const_iterator operator++(int) {const_iterator _copy_it(*this); ++(*this); return _copy_it;}
 
-        const_iterator& operator--()   {--_internal_it; return *this;}
-        const_iterator operator--(int) {const_iterator _copy_it(_internal_it); --(*this); return _copy_it;}
+        const_iterator& operator--()   {--_index; return *this;}
+        const_iterator operator--(int) {const_iterator _copy_it(*this); --(*this); return _copy_it;}
     };
 
 public:
     _Entity_Type* atUniqueId(u32 uniqueId);
     const _Entity_Type* atUniqueId(u32 uniqueId) const;
 
+    //invalid handle if the entity doesn't exist
+    EntityHandle getHandle(u32 uniqueId) const;
+
+    //nullptr if the entity was removed
+    _Entity_Type* atHandle(const EntityHandle& handle);
+    const _Entity_Type* atHandle(const EntityHandle& handle) const;
+
     _Entity_Type* addEntity(_Entity_Type* entity);
     
+    //the returned iterator points to the entity that took the place of the removed one
+    //(so it = removeEntity(it) still visits all entities)
     iterator removeEntity(u32 uniqueId);
     iterator removeEntity(iterator it);
     //should we add removeEntity that return const_iterator ??
@@ -80,7 +110,21 @@ public:
     void clear();
 
 private:
-    _Table m_table;
+    struct Slot {
+        u32 denseIndex = 0;
+        u32 generation = 1;
+    };
+
+    _Dense m_dense;
+
+    //slot of each entity in m_dense
+    std::vector<u32> m_denseSlots;
+
+    std::vector<Slot> m_slots;
+    std::vector<u32> m_freeSlots;
+
+    //uniqueId -> slot
+    FlatIndex m_index;
 };
 
 #include "entity_table.inl"
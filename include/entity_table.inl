@@ -5,27 +5,62 @@
 template<typename _Entity_Type>
 _Entity_Type* EntityTable<_Entity_Type>::atUniqueId(u32 uniqueId)
 {
-    typename _Table::iterator it = m_table.find(uniqueId);
+    const u32* slot = m_index.find(uniqueId);
 
-    if (it == m_table.end()) {
+    if (!slot) {
         return nullptr;
     } else {
-        return it->second.get();
+        return m_dense[m_slots[*slot].denseIndex].get();
     }
 }
 
 template<typename _Entity_Type>
 const _Entity_Type* EntityTable<_Entity_Type>::atUniqueId(u32 uniqueId) const
 {
-    typename _Table::const_iterator it = m_table.find(uniqueId);
+    const u32* slot = m_index.find(uniqueId);
 
-    if (it == m_table.end()) {
+    if (!slot) {
         return nullptr;
     } else {
-        return it->second.get();
+        return m_dense[m_slots[*slot].denseIndex].get();
     }
 }
 
+template<typename _Entity_Type>
+EntityHandle EntityTable<_Entity_Type>::getHandle(u32 uniqueId) const
+{
+    EntityHandle handle;
+
+    const u32* slot = m_index.find(uniqueId);
+
+    if (slot) {
+        handle.slot = *slot;
+        handle.generation = m_slots[*slot].generation;
+    }
+
+    return handle;
+}
+
+template<typename _Entity_Type>
+_Entity_Type* EntityTable<_Entity_Type>::atHandle(const EntityHandle& handle)
+{
+    if (handle.slot >= m_slots.size() || m_slots[handle.slot].generation != handle.generation) {
+        return nullptr;
+    }
+
+    return m_dense[m_slots[handle.slot].denseIndex].get();
+}
+
+template<typename _Entity_Type>
+const _Entity_Type* EntityTable<_Entity_Type>::atHandle(const EntityHandle& handle) const
+{
+    if (handle.slot >= m_slots.size() || m_slots[handle.slot].generation != handle.generation) {
+        return nullptr;
+    }
+
+    return m_dense[m_slots[handle.slot].denseIndex].get();
+}
+
 template<typename _Entity_Type>
 _Entity_Type* EntityTable<_Entity_Type>::addEntity(_Entity_Type* entity)
 {
@@ -34,12 +69,28 @@ _Entity_Type* EntityTable<_Entity_Type>::addEntity(_Entity_Type* entity)
         return nullptr;
     }
 
-    if (entity->getUniqueId() == 0 || m_table.find(entity->getUniqueId()) != m_table.end()) {
+    if (entity->getUniqueId() == 0 || m_index.find(entity->getUniqueId())) {
         std::cout << "EntityTable::addEntity error - Invalid or repeated uniqueId" << std::endl;
         return nullptr;
     }
 
-    m_table.emplace(entity->getUniqueId(), std::unique_ptr<_Entity_Type>(entity));
+    u32 slot;
+
+    if (m_freeSlots.empty()) {
+        slot = m_slots.size();
+        m_slots.emplace_back();
+
+    } else {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+
+    m_slots[slot].denseIndex = m_dense.size();
+
+    m_dense.emplace_back(entity);
+    m_denseSlots.push_back(slot);
+
+    m_index.insert(entity->getUniqueId(), slot);
 
     return entity;
 }
@@ -47,53 +98,80 @@ _Entity_Type* EntityTable<_Entity_Type>::addEntity(_Entity_Type* entity)
 template<typename _Entity_Type>
 typename EntityTable<_Entity_Type>::iterator EntityTable<_Entity_Type>::removeEntity(u32 uniqueId)
 {
-    typename _Table::iterator it = m_table.find(uniqueId);
+    const u32* slot = m_index.find(uniqueId);
 
-    if (it != m_table.end()) {
-        return iterator(m_table.erase(it));
+    if (slot) {
+        return removeEntity(iterator(&m_dense, m_slots[*slot].denseIndex));
     } else {
-        return iterator(m_table.end());
+        return end();
     }
 }
 
 template<typename _Entity_Type>
 typename EntityTable<_Entity_Type>::iterator EntityTable<_Entity_Type>::removeEntity(iterator it)
 {
-    return iterator(m_table.erase(it._internal_it));
+    const size_t index = it._index;
+    const u32 slot = m_denseSlots[index];
+
+    m_index.erase(m_dense[index]->getUniqueId());
+
+    //handles to the removed entity are no longer valid
+    m_slots[slot].generation++;
+    m_freeSlots.push_back(slot);
+
+    //the last entity takes its place
+    if (index != m_dense.size() - 1) {
+        m_dense[index] = std::move(m_dense.back());
+        m_denseSlots[index] = m_denseSlots.back();
+        m_slots[m_denseSlots[index]].denseIndex = index;
+    }
+
+    m_dense.pop_back();
+    m_denseSlots.pop_back();
+
+    return iterator(&m_dense, index);
 }
 
 template<typename _Entity_Type>
 typename EntityTable<_Entity_Type>::iterator EntityTable<_Entity_Type>::begin()
 {
-    return iterator(m_table.begin());
+    return iterator(&m_dense, 0);
 }
 
 template<typename _Entity_Type>
 typename EntityTable<_Entity_Type>::const_iterator EntityTable<_Entity_Type>::begin() const
 {
-    return const_iterator(m_table.begin());
+    return const_iterator(&m_dense, 0);
 }
 
 template<typename _Entity_Type>
 typename EntityTable<_Entity_Type>::iterator EntityTable<_Entity_Type>::end()
 {
-    return iterator(m_table.end());
+    return iterator(&m_dense, m_dense.size());
 }
 
 template<typename _Entity_Type>
 typename EntityTable<_Entity_Type>::const_iterator EntityTable<_Entity_Type>::end() const
 {
-    return const_iterator(m_table.end());
+    return const_iterator(&m_dense, m_dense.size());
 }
 
 template<typename _Entity_Type>
 size_t EntityTable<_Entity_Type>::size() const
 {
-    return m_table.size();
+    return m_dense.size();
 }
 
 template<typename _Entity_Type>
 void EntityTable<_Entity_Type>::clear()
 {
-    m_table.clear();
+    //existing handles stay invalid
+    for (u32 slot : m_denseSlots) {
+        m_slots[slot].generation++;
+        m_freeSlots.push_back(slot);
+    }
+
+    m_dense.clear();
+    m_denseSlots.clear();
+    m_index.clear();
 }
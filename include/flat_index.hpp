@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+
+#include "defines.hpp"
+
+//Open addressing hash table (linear probing) from a key to an index
+//All entries are stored in a single array, so lookups don't chase pointers
+//The key 0 is used to mark empty entries (0 is never a valid uniqueId)
+
+template<typename Key>
+class BasicFlatIndex
+{
+public:
+    BasicFlatIndex(size_t capacity = 0);
+
+    //returns false if the key is invalid or it already exists
+    bool insert(Key key, u32 value);
+
+    //returns false if the key doesn't exist
+    bool erase(Key key);
+
+    //nullptr if the key doesn't exist
+    u32* find(Key key);
+    const u32* find(Key key) const;
+
+    //keeps the allocated memory
+    void clear();
+
+    //avoids rehashing until there are more than count keys
+    void reserve(size_t count);
+
+    size_t size() const;
+
+private:
+    struct Entry {
+        Key key = 0;
+        u32 value = 0;
+    };
+
+    size_t _getHomeIndex(Key key) const;
+    size_t _findIndex(Key key) const;
+    void _rehash(size_t capacity);
+
+    //size is always a power of 2
+    std::vector<Entry> m_entries;
+    size_t m_size;
+};
+
+//indexed by uniqueId
+using FlatIndex = BasicFlatIndex<u32>;
+
+//indexed by keys made of several fields (like the snapshot chunks)
+using FlatIndex64 = BasicFlatIndex<u64>;
+
+#include "flat_index.inl"
@@ -0,0 +1,176 @@
+#include <algorithm>
+
+//the table grows when it's half full (probe sequences stay short)
+constexpr size_t FLAT_INDEX_MIN_CAPACITY = 16;
+
+//consecutive keys are spread over the table (the high bits of the product are folded into the low ones)
+inline size_t FlatIndex_hash(u32 key)
+{
+    u32 hash = key * 2654435769u;
+    hash ^= hash >> 16;
+
+    return hash;
+}
+
+inline size_t FlatIndex_hash(u64 key)
+{
+    u64 hash = key * 11400714819323198485ull;
+    hash ^= hash >> 32;
+
+    return static_cast<size_t>(hash);
+}
+
+template<typename Key>
+BasicFlatIndex<Key>::BasicFlatIndex(size_t capacity)
+{
+    m_size = 0;
+
+    if (capacity > 0) {
+        reserve(capacity);
+    }
+}
+
+template<typename Key>
+bool BasicFlatIndex<Key>::insert(Key key, u32 value)
+{
+    if (key == 0) return false;
+
+    if ((m_size + 1) * 2 > m_entries.size()) {
+        _rehash(std::max(m_entries.size() * 2, FLAT_INDEX_MIN_CAPACITY));
+    }
+
+    const size_t mask = m_entries.size() - 1;
+    size_t i = _getHomeIndex(key);
+
+    while (m_entries[i].key != 0) {
+        if (m_entries[i].key == key) return false;
+
+        i = (i + 1) & mask;
+    }
+
+    m_entries[i].key = key;
+    m_entries[i].value = value;
+    m_size++;
+
+    return true;
+}
+
+template<typename Key>
+bool BasicFlatIndex<Key>::erase(Key key)
+{
+    size_t i = _findIndex(key);
+
+    if (i == m_entries.size()) return false;
+
+    const size_t mask = m_entries.size() - 1;
+
+    //move back the entries that follow so no probe sequence is broken
+    //(this way there's no need for tombstones)
+    size_t j = i;
+
+    while (true) {
+        j = (j + 1) & mask;
+
+        if (m_entries[j].key == 0) break;
+
+        const size_t home = _getHomeIndex(m_entries[j].key);
+
+        //the entry can be moved if its home is not in (i, j] (cyclically)
+        const bool canMove = (i <= j) ? (home <= i || home > j) : (home <= i && home > j);
+
+        if (canMove) {
+            m_entries[i] = m_entries[j];
+            i = j;
+        }
+    }
+
+    m_entries[i] = Entry();
+    m_size--;
+
+    return true;
+}
+
+template<typename Key>
+u32* BasicFlatIndex<Key>::find(Key key)
+{
+    size_t i = _findIndex(key);
+
+    if (i == m_entries.size()) return nullptr;
+
+    return &m_entries[i].value;
+}
+
+template<typename Key>
+const u32* BasicFlatIndex<Key>::find(Key key) const
+{
+    size_t i = _findIndex(key);
+
+    if (i == m_entries.size()) return nullptr;
+
+    return &m_entries[i].value;
+}
+
+template<typename Key>
+void BasicFlatIndex<Key>::clear()
+{
+    std::fill(m_entries.begin(), m_entries.end(), Entry());
+    m_size = 0;
+}
+
+template<typename Key>
+void BasicFlatIndex<Key>::reserve(size_t count)
+{
+    size_t capacity = FLAT_INDEX_MIN_CAPACITY;
+
+    while (capacity < count * 2) {
+        capacity *= 2;
+    }
+
+    if (capacity > m_entries.size()) {
+        _rehash(capacity);
+    }
+}
+
+template<typename Key>
+size_t BasicFlatIndex<Key>::size() const
+{
+    return m_size;
+}
+
+template<typename Key>
+size_t BasicFlatIndex<Key>::_getHomeIndex(Key key) const
+{
+    return FlatIndex_hash(key) & (m_entries.size() - 1);
+}
+
+template<typename Key>
+size_t BasicFlatIndex<Key>::_findIndex(Key key) const
+{
+    if (key == 0 || m_size == 0) return m_entries.size();
+
+    const size_t mask = m_entries.size() - 1;
+    size_t i = _getHomeIndex(key);
+
+    while (m_entries[i].key != 0) {
+        if (m_entries[i].key == key) return i;
+
+        i = (i + 1) & mask;
+    }
+
+    return m_entries.size();
+}
+
+template<typename Key>
+void BasicFlatIndex<Key>::_rehash(size_t capacity)
+{
+    std::vector<Entry> oldEntries(capacity);
+    oldEntries.swap(m_entries);
+
+    m_size = 0;
+
+    for (const Entry& entry : oldEntries) {
+        if (entry.key != 0) {
+            insert(entry.key, entry.value);
+        }
+    }
+}
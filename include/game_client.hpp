@@ -15,6 +15,7 @@
 #include "client_caster.hpp"
 #include "caster_snapshot.hpp"
 #include "connection_status_render.hpp"
+#include "memory_stats.hpp"
 
 class GameClient;
 
@@ -50,6 +51,8 @@ public:
         CasterSnapshot caster;
     };
 
+    typedef std::list<Snapshot, TrackedAllocator<Snapshot, MEMORY_TAG_CLIENT_SNAPSHOTS>> SnapshotList;
+
     struct InputSnapshot {
         PlayerInput input;
         Vector2 endPosition;
@@ -106,10 +109,10 @@ private:
     bool m_canvasCreated;
 
     C_EntityManager m_entityManager;
-    std::list<Snapshot> m_snapshots;
+    SnapshotList m_snapshots;
 
     //snapshot we're currently using to interpolate
-    std::list<Snapshot>::iterator m_interSnapshot_it;
+    SnapshotList::iterator m_interSnapshot_it;
 
     sf::Time m_worldTime;
     sf::Time m_interElapsed;
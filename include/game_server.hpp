@@ -2,21 +2,29 @@
 
 #include <steam/steamnetworkingsockets.h>
 #include <SFML/System/Time.hpp>
-#include <unordered_map>
 
 #include "paths.hpp"
 #include "context.hpp"
 #include "bucket.hpp"
+#include "flat_index.hpp"
 #include "net_peer.hpp"
 
 #include "server_entity_manager.hpp"
 #include "collision_manager.hpp"
+#include "lag_compensation.hpp"
+#include "snapshot_history.hpp"
+#include "worker_pool.hpp"
+#include "tick_scheduler.hpp"
 
 #include "tilemap.hpp"
 #include "game_mode.hpp"
 
 class GameServer;
 
+//snapshots clients buffer before rendering them (interpolation delay)
+constexpr u8 DEFAULT_REQUIRED_SNAPSHOTS_TO_RENDER = 3;
+constexpr u8 MAX_REQUIRED_SNAPSHOTS_TO_RENDER = 10;
+
 struct GameServerCallbacks : public ISteamNetworkingSocketsCallbacks
 {
     GameServerCallbacks(GameServer* p);
@@ -32,6 +40,24 @@ class GameServer : public InContext, public NetPeer
 public:
     friend struct GameServerCallbacks;
 
+    //latest data of an entity the client received
+    struct ReceivedEntity {
+        u32 uniqueId = 0;
+
+        //snapshot where the entity was last sent
+        u32 snapshotId = 0;
+    };
+
+    //entities and projectiles the client has after applying a snapshot
+    //(entities that didn't fit in the snapshot keep the data of an older one)
+    struct ClientView {
+        u32 snapshotId = 0;
+
+        //both sorted by uniqueId
+        std::vector<ReceivedEntity> entities;
+        std::vector<u32> projectiles;
+    };
+
     struct ClientInfo {
         u32 uniqueId = 0;
         HSteamNetConnection connectionId = k_HSteamNetConnection_Invalid;
@@ -41,6 +67,7 @@ public:
         bool forceFullUpdate = false;
 
         sf::Time snapshotRate;
+        sf::Time snapshotTimer; //time since the last snapshot was sent
         u32 latestInputId = 0;
         sf::Time inputRate;
         u8 inputsSent = 0; //this update
@@ -60,6 +87,57 @@ public:
         u8 pickedHeroType = ENTITY_MAX_TYPES;
 
         int ping = -1;
+
+        //the client renders other entities this many snapshots in the past
+        u8 requiredSnapshotsToRender = DEFAULT_REQUIRED_SNAPSHOTS_TO_RENDER;
+
+        //indexed by snapshotId (same size as the snapshot history)
+        std::vector<ClientView> sentViews;
+    };
+
+    //entity or projectile packed once per update for all clients that need the same data
+    struct EncodedChunk {
+        u32 uniqueId = 0;
+        bool projectile = false;
+        u8 teamId = 0;
+
+        //0 if it's sent in full
+        u32 prevSnapshotId = 0;
+
+        CRCPacket data;
+    };
+
+    //chunk that might be included in the snapshot of a client
+    struct SnapshotItem {
+        u32 uniqueId = 0;
+        size_t chunkIndex = 0;
+
+        //required items are sent even if they exceed the byte budget
+        bool required = false;
+        float priority = 0.f;
+    };
+
+    //snapshot packet of a client that has to be sent this update
+    struct PendingSnapshot {
+        int clientIndex = 0;
+        u8 teamId = 0;
+
+        //nullptr if there's no baseline
+        const ClientView* baselineView = nullptr;
+
+        std::vector<SnapshotItem> entities;
+        std::vector<SnapshotItem> projectiles;
+
+        //entities the client has in the baseline that are no longer sent
+        std::vector<u32> removedEntities;
+
+        bool sendControlledData = false;
+        CRCPacket controlledData;
+
+        //what the client will have after receiving this snapshot
+        ClientView view;
+
+        CRCPacket packet;
     };
 
     //data we're not using as much
@@ -70,21 +148,36 @@ public:
         //cosmetics??
     };
 
-    struct Snapshot {
-        EntityManager entityManager;
-        u32 id = 0;
-        sf::Time worldTime;
-    };
-
 public:
     GameServer(const Context& context, u8 gameModeType);
     ~GameServer();
 
     void mainLoop(bool& running);
+    void printTickStats() const;
+
+    //reads commands typed in the server console (without blocking)
+    void handleConsoleInput();
+    void handleConsoleCommand(const std::string& command);
 
     void receiveLoop();
     void update(const sf::Time& eTime, bool& running);
-    void sendSnapshots();
+    void sendSnapshots(const sf::Time& eTime);
+
+    //entities and projectiles of the client's interest region that have to be considered for the snapshot
+    void addSnapshotItems(PendingSnapshot& pending, const ClientInfo& client);
+
+    //selects the items that fit in the byte budget (by priority) and writes the snapshot
+    void packSnapshot(PendingSnapshot& pending, const ClientInfo& client);
+
+    //each chunk is encoded only once per update
+    //returns the index in m_chunks
+    size_t addChunk(u32 uniqueId, bool projectile, u8 teamId, u32 prevSnapshotId);
+
+    //entity the client is looking at (controlled or spectated)
+    const Entity* getViewedEntity(const ClientInfo& client) const;
+
+    //region around the controlled (or spectated) entity
+    sf::FloatRect getInterestRegion(const ClientInfo& client) const;
 
     void processPacket(HSteamNetConnection connectionId, CRCPacket& packet);
     void handleCommand(u8 command, int index, CRCPacket& packet);
@@ -95,6 +188,8 @@ public:
 
     int addClient();
     bool canNewClientConnect() const;
+
+    void setClientSnapshotRate(int index, const sf::Time& snapshotRate);
     
     bool addClientToPoll(int index);
     int getIndexByConnectionId(HSteamNetConnection connectionId) const;
@@ -124,18 +219,56 @@ private:
     sf::Time m_minSnapshotRate;
     sf::Time m_maxPingCorrection;
 
+    bool m_interestManagement;
+    Vector2 m_interestViewSize;
+    float m_interestMargin;
+
+    //maximum size of a snapshot packet
+    size_t m_snapshotByteBudget;
+
     //used to safely shutdown the server with Ctrl+C
     static bool SIGNAL_SHUTDOWN;
 
+    //the memory stats are logged this often (0 disables it)
+    sf::Time m_memoryLogInterval;
+
+    //console input that doesn't form a full line yet
+    std::string m_consoleLine;
+
+    //stdin reached EOF (or can't be read), so it's no longer polled
+    bool m_consoleClosed;
+
     Bucket<ClientInfo> m_clients;
     u32 m_lastClientId;
 
-    std::unordered_map<u32, Snapshot> m_snapshots;
+    SnapshotHistory m_snapshots;
     EntityManager m_entityManager;
     u32 m_lastSnapshotId;
 
+    //packets are reused between updates to avoid allocations
+    std::vector<EncodedChunk> m_chunks;
+    size_t m_chunkCount;
+    std::vector<PendingSnapshot> m_pendingSnapshots;
+    size_t m_pendingSnapshotCount;
+
+    //index in m_chunks of the chunks added this update
+    FlatIndex64 m_chunkIndices;
+
+    //used while adding snapshot items
+    std::vector<u32> m_interestEntities;
+    std::vector<u32> m_interestProjectiles;
+
+    //sleeps between updates
+    TickScheduler m_tickScheduler;
+
+    //encodes the snapshot packets
+    WorkerPool m_workerPool;
+
     CollisionManager m_collisionManager;
 
+    //entities in the broadphase of the latest updates (to rewind them for lagged clients)
+    LagCompensation m_lagCompensation;
+
     TileMap m_tileMap;
 
     sf::Time m_worldTime;
@@ -36,7 +36,11 @@ public:
     virtual Hero* clone() const;
 
     virtual void loadFromJson(const rapidjson::Document& doc);
-    virtual void packData(const Entity* prevEntity, u8 teamId, u32 controlledEntityUniqueId, CRCPacket& outPacket) const;
+
+    typedef HeroNetState NetState;
+
+    virtual void packData(const EntityNetState* prevState, u8 teamId, const Vector2u& worldSize, CRCPacket& outPacket) const;
+    virtual void takeNetState(EntityNetState& state) const;
 
     virtual void onDeath(bool& dead, const ManagersContext& context);
 
@@ -57,7 +61,7 @@ public:
     virtual C_Hero* clone() const;
 
     virtual void loadFromJson(const rapidjson::Document& doc, u16 textureId, const Context& context);
-    virtual void loadFromData(u32 controlledEntityUniqueId, CRCPacket& inPacket, CasterSnapshot& casterSnapshot);
+    virtual void loadFromData(const Vector2u& worldSize, CRCPacket& inPacket, CasterSnapshot& casterSnapshot);
 
     virtual void insertRenderNode(sf::Time eTime, const C_ManagersContext& managersContext, const Context& context);
 
@@ -8,6 +8,9 @@
 class JsonParser
 {
 public:
+    JsonParser() = default;
+    ~JsonParser();
+
     void loadAll(const std::string& dir);
 
     void loadDocument(const std::string& filename, const std::string& id);
@@ -19,5 +22,9 @@ public:
     bool isLoaded(const std::string& id) const;
 
 private:
+    //bytes used by the documents (reported to MemoryStats)
+    void trackDocument(rapidjson::Document& document);
+
     std::map<std::string, std::unique_ptr<rapidjson::Document>> m_documents;
+    size_t m_trackedBytes = 0;
 };
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vector>
+#include <SFML/System/Time.hpp>
+
+#include "defines.hpp"
+#include "bounding_body.hpp"
+#include "memory_stats.hpp"
+
+class CollisionManager;
+
+//Ring buffer with the position and radius of the entities in the broadphase after each update
+//Lagged clients see other entities in the past (ping plus interpolation delay), so their
+//hits are checked against the entities rewound to that time instead of where they are now
+//Positions between two updates are interpolated
+
+class LagCompensation
+{
+public:
+    struct Record {
+        u32 uniqueId;
+        Vector2 pos;
+        u8 radius;
+        u8 teamId;
+    };
+
+    LagCompensation(size_t size = 32);
+
+    //removes all stored updates
+    void resize(size_t size);
+    void clear();
+
+    //stores the entities in the broadphase at this world time
+    //(world times have to be increasing)
+    void record(sf::Time worldTime, const CollisionManager& collisionManager);
+
+    //visitor(const Record& record) is called for each entity that intersects the region at worldTime
+    //worldTime is clamped to the stored history
+    //it returns true to stop the query (returns true if it was stopped)
+    template<typename Visitor>
+    bool forEachIntersecting(sf::Time worldTime, const BoundingBodyf& region, Visitor visitor) const;
+
+    sf::Time getOldestTime() const;
+    sf::Time getLatestTime() const;
+
+    //number of updates stored
+    size_t getCount() const;
+
+private:
+    typedef std::vector<Record, TrackedAllocator<Record, MEMORY_TAG_LAG_COMPENSATION>> RecordVector;
+
+    struct Frame {
+        sf::Time worldTime;
+
+        //sorted by uniqueId
+        RecordVector records;
+    };
+
+    const Frame& _getFrame(size_t i) const;
+
+    //newer is nullptr if worldTime is not between two updates
+    void _findFrames(sf::Time worldTime, const Frame*& older, const Frame*& newer, float& alpha) const;
+
+    static const Record* _findRecord(const Frame& frame, u32 uniqueId);
+
+    std::vector<Frame> m_frames;
+
+    //index of the oldest update
+    size_t m_first;
+    size_t m_count;
+};
+
+#include "lag_compensation.inl"
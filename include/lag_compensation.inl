@@ -0,0 +1,30 @@
+#include "lag_compensation.hpp"
+
+template<typename Visitor>
+bool LagCompensation::forEachIntersecting(sf::Time worldTime, const BoundingBodyf& region, Visitor visitor) const
+{
+    if (m_count == 0) return false;
+
+    const Frame* older;
+    const Frame* newer;
+    float alpha;
+
+    _findFrames(worldTime, older, newer, alpha);
+
+    for (const Record& olderRecord : older->records) {
+        Record record = olderRecord;
+
+        //entities removed before the next update are still where they were
+        const Record* newerRecord = (newer ? _findRecord(*newer, record.uniqueId) : nullptr);
+
+        if (newerRecord) {
+            record.pos += (newerRecord->pos - olderRecord.pos) * alpha;
+        }
+
+        if (region.Intersects(BoundingBodyf(Circlef(record.pos, record.radius))) && visitor(record)) {
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -4,6 +4,7 @@ class EntityManager;
 class CollisionManager;
 class TileMap;
 class GameMode;
+class LagCompensation;
 
 struct ManagersContext {
     EntityManager* entityManager;
@@ -11,20 +12,25 @@ struct ManagersContext {
     TileMap* tileMap;
     GameMode* gameMode;
 
+    //optional, without it lagged hits are checked against current positions
+    LagCompensation* lagCompensation;
+
     ManagersContext()
     {
         entityManager = nullptr;
         collisionManager = nullptr;
         tileMap = nullptr;
         gameMode = nullptr;
+        lagCompensation = nullptr;
     }
 
-    ManagersContext(EntityManager* e, CollisionManager* c, TileMap* t, GameMode* g)
+    ManagersContext(EntityManager* e, CollisionManager* c, TileMap* t, GameMode* g, LagCompensation* l = nullptr)
     {
         entityManager = e;
         collisionManager = c;
         tileMap = t;
         gameMode = g;
+        lagCompensation = l;
     }
 };
 
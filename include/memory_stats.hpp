@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "defines.hpp"
+
+//Memory accounting of the subsystems that grow with the size of a match
+//Each subsystem reports what it allocates and frees under its tag, and
+//the current and peak bytes of each tag can be printed (server console and log)
+//Counters are atomic since the server and the client can run in different threads
+
+enum MemoryTag {
+    MEMORY_TAG_SNAPSHOT_HISTORY,
+    MEMORY_TAG_CLIENT_SNAPSHOTS,
+    MEMORY_TAG_QUADTREE,
+    MEMORY_TAG_UNIFORM_GRID,
+    MEMORY_TAG_LAG_COMPENSATION,
+    MEMORY_TAG_BUCKETS,
+    MEMORY_TAG_ENTITY_POOLS,
+    MEMORY_TAG_JSON,
+
+    MEMORY_TAG_MAX
+};
+
+struct MemoryStats {
+    size_t current = 0;
+    size_t peak = 0;
+};
+
+void MemoryStats_allocate(MemoryTag tag, size_t bytes);
+void MemoryStats_deallocate(MemoryTag tag, size_t bytes);
+
+MemoryStats MemoryStats_get(MemoryTag tag);
+const char* MemoryStats_tagName(MemoryTag tag);
+
+//one line per tag
+void MemoryStats_print();
+
+//all tags in a single line (for the periodic log)
+std::string MemoryStats_summary();
+
+//STL allocator that reports its allocations under a tag
+template<typename T, MemoryTag _Tag>
+struct TrackedAllocator {
+    typedef T value_type;
+
+    template<typename U>
+    struct rebind {typedef TrackedAllocator<U, _Tag> other;};
+
+    TrackedAllocator() = default;
+
+    template<typename U>
+    TrackedAllocator(const TrackedAllocator<U, _Tag>&) {}
+
+    T* allocate(std::size_t n)
+    {
+        MemoryStats_allocate(_Tag, n * sizeof(T));
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n)
+    {
+        MemoryStats_deallocate(_Tag, n * sizeof(T));
+        std::allocator<T>().deallocate(p, n);
+    }
+};
+
+template<typename T, typename U, MemoryTag _Tag>
+bool operator==(const TrackedAllocator<T, _Tag>& lhs, const TrackedAllocator<U, _Tag>& rhs) {return true;}
+
+template<typename T, typename U, MemoryTag _Tag>
+bool operator!=(const TrackedAllocator<T, _Tag>& lhs, const TrackedAllocator<U, _Tag>& rhs) {return false;}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <SFML/Graphics/Rect.hpp>
+#include "defines.hpp"
+
+//Compact copy of the data packData compares against
+//(snapshots store these instead of cloning whole entities)
+//Each entity class declares the NetState it uses (Entity::NetState by default)
+//They have to be plain structs: snapshots zero them, copy them and compare them as raw memory
+
+//must be at least HeroBase::maxDisplayNameSize + 1
+constexpr size_t NET_STATE_DISPLAY_NAME_SIZE = 33;
+
+struct EntityNetState {
+    u32 uniqueId;
+    u8 type;
+
+    Vector2 pos;
+    u8 teamId;
+    u8 collisionRadius;
+    u8 flyingHeight;
+};
+
+struct UnitNetState : EntityNetState {
+    u16 health;
+    u16 maxHealth;
+    float aimAngle;
+};
+
+struct HeroNetState : UnitNetState {
+    u8 powerLevel;
+    char displayName[NET_STATE_DISPLAY_NAME_SIZE];
+};
+
+struct CrateNetState : EntityNetState {
+    u16 health;
+    u16 maxHealth;
+};
+
+struct ProjectileNetState {
+    u32 uniqueId = 0;
+
+    Vector2 pos;
+    u8 collisionRadius = 0;
+    float rotation = 0.f;
+};
+
+//entities and projectiles are only sent to a client if they intersect its interest region
+//(the same test is done with the baseline data to know what the client already has)
+bool NetState_isInInterest(const sf::FloatRect& region, const Vector2& pos, u8 collisionRadius);
@@ -20,5 +20,6 @@ enum class ServerCommand {
     ChangeInputRate,
     ChangeSnapshotRate,
     DisplayName,
-    PickedHero
+    PickedHero,
+    ChangeRequiredSnapshotsToRender
 };
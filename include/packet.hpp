@@ -5,6 +5,10 @@
  * when packing multiple booleans in a row.
  * 
  * (see https://github.com/SFML/SFML/pull/1689)
+ *
+ * Values of any bit width (and variable-length integers) can also be
+ * packed in the same bytes as the booleans. Any other value written
+ * after them starts at the next byte.
  */
 
 #include <SFML/System/String.hpp>
@@ -28,6 +32,22 @@ public:
 
     bool endOfPacket() const;
 
+    //bitCount has to be between 1 and 32
+    void writeBits(sf::Uint32 value, std::size_t bitCount);
+    void readBits(sf::Uint32& value, std::size_t bitCount);
+
+    //groups of 7 bits with a continuation bit (small values use less space)
+    void writeVarUint(sf::Uint32 value);
+    void readVarUint(sf::Uint32& value);
+
+    //zigzag encoded so small negative values are small too
+    void writeVarInt(sf::Int32 value);
+    void readVarInt(sf::Int32& value);
+
+    //skips the unread bits of the current byte
+    //(data appended from another packet always starts at a new byte)
+    void alignRead();
+
 public:
     operator BoolType() const;
 
@@ -81,6 +101,7 @@ private:
     std::size_t       m_sendPos;
     bool              m_isValid;
 
-    std::size_t m_boolReadPos;
-    std::size_t m_boolSendPos;
+    //position of the next bit in the last byte (0 if a new byte has to be used)
+    std::size_t m_bitReadPos;
+    std::size_t m_bitSendPos;
 };
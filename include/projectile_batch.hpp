@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+
+#include "defines.hpp"
+#include "bucket.hpp"
+#include "projectiles.hpp"
+#include "uniform_grid.hpp"
+
+//Structure of arrays with the data needed to move projectiles
+//All projectiles are moved (and expired) in a single SIMD loop, and then
+//collisions are checked in a second pass (see EntityManager::update)
+//Arrays are padded to a multiple of the SIMD width
+
+constexpr size_t PROJECTILE_BATCH_WIDTH = 4;
+
+//projectiles close to each other query the broadphase one after the other
+constexpr float PROJECTILE_BATCH_CELL_SIZE = DEFAULT_GRID_CELL_SIZE;
+
+struct ProjectileHit {
+    u32 projectileIndex;
+    const BroadphaseProxy* proxy;
+
+    //fraction of the movement until the hit
+    float time;
+};
+
+struct ProjectileBatch {
+    std::vector<float> posX;
+    std::vector<float> posY;
+    std::vector<float> velX;
+    std::vector<float> velY;
+    std::vector<float> speed;
+    std::vector<float> distanceTraveled;
+
+    //0 means the projectile can travel infinitely
+    std::vector<float> range;
+
+    //projectiles that were already dead are marked as expired
+    std::vector<u8> expired;
+
+    size_t count = 0;
+
+    //positions before moving (collisions are swept from them)
+    std::vector<Vector2> startPos;
+
+    //(cell, index) of the projectiles checked against the broadphase
+    std::vector<std::pair<u32, u32>> collisionOrder;
+
+    //sorted by projectile index
+    std::vector<ProjectileHit> hits;
+
+    //change count of the broadphase when the hits were found
+    u32 broadphaseChangeCount = 0;
+};
+
+void ProjectileBatch_gather(ProjectileBatch& batch, const Bucket<Projectile>& projectiles);
+
+//moves the projectiles that haven't traveled their range, the rest are expired
+void ProjectileBatch_integrate(ProjectileBatch& batch, float eTime);
+
+//only the first batch.count projectiles of the bucket are written
+void ProjectileBatch_scatter(const ProjectileBatch& batch, Bucket<Projectile>& projectiles);
+
+//tests the movement of all the alive projectiles against the broadphase in one pass (sorted by cell)
+//the hit of each projectile is the same one Projectile_findHit returns
+void ProjectileBatch_findHits(ProjectileBatch& batch, const Bucket<Projectile>& projectiles, CollisionManager& collisionManager);
+
+//checks tile collisions and applies the hits in projectile order
+//if Projectile_onHit changes the broadphase the rest of the hits are found again with Projectile_findHit
+void ProjectileBatch_applyHits(const ProjectileBatch& batch, Bucket<Projectile>& projectiles, const ManagersContext& context);
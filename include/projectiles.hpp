@@ -6,6 +6,8 @@
 #include "managers_context.hpp"
 #include "context.hpp"
 #include "json_parser.hpp"
+#include "net_state.hpp"
+#include "quantize.hpp"
 
 //???
 //@TODO: Projectiles should be encapsulated in a more general class
@@ -15,6 +17,9 @@
 
 class Entity;
 class Unit;
+class CollisionManager;
+class LagCompensation;
+struct BroadphaseProxy;
 
 enum ProjectileType {
     #define DoProjectile(projectile_name, json_id) \
@@ -30,6 +35,9 @@ enum ProjectileType {
 //other things can be provided by their units as well (overwriting the defaults)
 constexpr size_t MAX_PROJECTILES = 2000;
 
+//projectiles move too fast to be sent as deltas, so less precision is needed
+constexpr float DEFAULT_PROJECTILE_POSITION_PRECISION = 0.25f;
+
 namespace HitFlags 
 {
     enum _HitFlags {
@@ -61,6 +69,9 @@ struct _BaseProjectileData
     u16 range;
 
     float rotation;
+
+    //world units of each step when the position is sent
+    float positionPrecision;
 };
 
 struct Projectile : _BaseProjectileData 
@@ -109,12 +120,30 @@ void C_Projectile_init(C_Projectile& projectile, u8 type);
 //Used to locally predict projectiles when player fires
 void C_Projectile_init(C_Projectile& projectile, u8 type, const Vector2& pos, float aimAngle);
 
-void Projectile_packData(const Projectile& projectile, const Projectile* prevProj, u8 teamId, CRCPacket& outPacket, const EntityManager* entityManager);
-void C_Projectile_loadFromData(C_Projectile& projectile, CRCPacket& inPacket);
+void Projectile_packData(const Projectile& projectile, const ProjectileNetState* prevProj, u8 teamId, const Vector2u& worldSize, CRCPacket& outPacket, const EntityManager* entityManager);
+void Projectile_takeNetState(const Projectile& projectile, ProjectileNetState& state);
+void C_Projectile_loadFromData(C_Projectile& projectile, const Vector2u& worldSize, CRCPacket& inPacket);
 
 void Projectile_update(Projectile& projectile, sf::Time eTime, const ManagersContext& context);
 
-//clientDelay in ms
+//collisions with tiles and entities while moving from start to the current position (swept circle)
+//(EntityManager checks all projectiles in a batch instead, see ProjectileBatch_findHits)
+void Projectile_checkCollisions(Projectile& projectile, const Vector2& start, const ManagersContext& context);
+
+//kills the projectile if it went through a wall or a block since start
+//t is the fraction of the movement until the tile was hit
+bool Projectile_checkTileCollisions(Projectile& projectile, const Vector2& start, const ManagersContext& context, float& t);
+
+//first entity in the broadphase the projectile can hit moving from start (nullptr if there is none)
+//projectiles only hit one entity, t is the fraction of the movement until the hit
+const BroadphaseProxy* Projectile_findHit(const Projectile& projectile, const Vector2& start, CollisionManager& collisionManager, float& t);
+
+//same as Projectile_findHit with the entities as they were at worldTime
+//returns the uniqueId of the entity hit (0 if there is none)
+u32 Projectile_findRewoundHit(const Projectile& projectile, const Vector2& start, const LagCompensation& lagCompensation, sf::Time worldTime, float& t);
+
+//moves the projectile as if it was created clientDelay ms ago (in a single swept update)
+//entities are rewound to that time if context.lagCompensation is set
 void Projectile_backtrackCollisions(Projectile& projectile, const ManagersContext& context, u16 clientDelay);
 
 //simply update the position of the projectile using its velocity
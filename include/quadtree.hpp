@@ -27,6 +27,7 @@
 
 #include "helper.hpp"
 #include "bounding_body.hpp"
+#include "memory_stats.hpp"
 
 template <typename NumberT, typename ObjectT, typename BoundingBoxExtractorT>
 class Quadtree {
@@ -71,9 +72,16 @@ public:
     Query QueryIntersectsRegion(const BoundingBody<Number>& region);
     Query QueryInsideRegion(const BoundingBody<Number>& region);
     Query QueryContainsRegion(const BoundingBody<Number>& region);
+    template <typename Visitor>
+    bool ForEachIntersecting(const BoundingBody<Number>& region, Visitor visitor);
+    ///< visitor(Object*) returns true to stop the query, true if it was stopped
+    ///< it doesn't need a Query from the pool (the tree can't be cleared inside visitor)
+    void CollectIntersecting(const BoundingBody<Number>& region, std::vector<Object*>& objects);
+    ///< objects is cleared first (reusing the same vector avoids allocations)
     const BoundingBody<Number>& GetLooseBoundingBox() const;
     ///< double its size to get a bounding box including everything contained for sure
     int GetSize() const;
+    int GetNodeCount() const; ///< nodes currently allocated in the tree (used in tests)
     bool IsEmpty() const;
     void Clear();
     void ForceCleanup(); ///< does a full data structure and memory cleanup
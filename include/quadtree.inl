@@ -122,6 +122,7 @@ T* BlocksAllocatorAdaptor<T>::allocate(std::size_t n) {
         return reinterpret_cast<T*>(allocator_->Allocate(sizeof(T)));
     }
     else {
+        MemoryStats_allocate(MEMORY_TAG_QUADTREE, sizeof(T) * n);
         return reinterpret_cast<T*>(new char[sizeof(T) * n]);
     }
 }
@@ -132,6 +133,7 @@ void BlocksAllocatorAdaptor<T>::deallocate(T* p, std::size_t n) {
         allocator_->Deallocate(p, sizeof(T));
     }
     else {
+        MemoryStats_deallocate(MEMORY_TAG_QUADTREE, sizeof(T) * n);
         delete[] reinterpret_cast<char*>(p);
     }
 }
@@ -299,8 +301,11 @@ public:
     Query QueryIntersectsRegion(const BoundingBody<Number>& region);
     Query QueryInsideRegion(const BoundingBody<Number>& region);
     Query QueryContainsRegion(const BoundingBody<Number>& region);
+    template <typename Visitor>
+    bool ForEachIntersecting(const BoundingBody<Number>& region, Visitor& visitor);
     const BoundingBody<Number>& GetBoundingBox() const; ///< loose sense bounds
     int GetSize() const;
+    int GetNodeCount() const;
     void Clear();
     void ForceCleanup();
 
@@ -316,6 +321,7 @@ private:
     void RecalculateMaximalDepth();
     void DeleteTree();
     Object** InsertIntoTree(Object* object);
+    void CleanupNode(detail::TreeNode<Object>* node, detail::TreeNode<Object>** slot, int depth);
     typename Query::Impl* GetAvailableQueryFromPool();
 
     detail::BlocksAllocator allocator_;
@@ -900,6 +906,211 @@ QueryContainsRegion(const BoundingBody<Number>& region) -> Query {
     return Query(query_impl);
 }
 
+template <typename NumberT, typename ObjectT, typename BoundingBoxExtractorT>
+template <typename Visitor>
+bool
+    Quadtree<NumberT, ObjectT, BoundingBoxExtractorT>::Impl::
+ForEachIntersecting(const BoundingBody<Number>& region, Visitor& visitor) {
+    // same traversal order and node fitting as Query::Impl with kIntersects,
+    // but the nodes still to visit are kept in a fixed stack (depth first, 3 siblings per level)
+    struct PendingNode {
+        detail::TreeNode<Object>* node;
+        detail::TreeNode<Object>** slot; ///< pointer to the node in its parent (or root_)
+        Number left;
+        Number top;
+        Number width;
+        Number height;
+        int depth;
+        bool free_ride;
+        bool leaving; ///< all its children have been visited
+    };
+
+    if (root_ == nullptr) {
+        return false;
+    }
+
+    // one node being left and 3 siblings per level
+    PendingNode stack[4 * (kInternalMaxDepth + 1) + 1];
+    int stack_size = 0;
+
+    stack[stack_size++] = {root_, &root_, bounding_box_.rect.left, bounding_box_.rect.top,
+        bounding_box_.rect.width, bounding_box_.rect.height, 0, false, false};
+
+    // the tree is only cleaned up if no other query is running, since they could be iterating the same nodes
+    // (removed objects are erased, and nodes are cleaned up when they're left, like Query::Impl::Next does)
+    const bool cleanup = (running_queries_ == 0);
+
+    // prevents other queries from cleaning up the nodes in the stack
+    running_queries_++;
+
+    BoundingBody<Number> object_bounds;
+
+    while (stack_size > 0) {
+        const PendingNode pending = stack[--stack_size];
+
+        if (pending.leaving) {
+            CleanupNode(pending.node, pending.slot, pending.depth);
+            continue;
+        }
+
+        const BoundingBody<Number> node_bounds(RotatingRect<Number>(pending.left, pending.top, pending.width, pending.height));
+        bool free_ride = pending.free_ride;
+
+        if (!free_ride) {
+            Number half_width = (Number)((typename detail::MakeDistance<Number>::Type)pending.width / 2);
+            Number half_height = (Number)((typename detail::MakeDistance<Number>::Type)pending.height / 2);
+
+            const BoundingBody<Number> extended_bounds(RotatingRect<Number>((Number)(pending.left - half_width),
+                (Number)(pending.top - half_height), (Number)(pending.width * 2), (Number)(pending.height * 2)));
+
+            if (!region.Intersects(extended_bounds)) {
+                if (cleanup) {
+                    CleanupNode(pending.node, pending.slot, pending.depth);
+                }
+
+                continue;
+            }
+
+            free_ride = region.Contains(node_bounds);
+        }
+
+        typename detail::TreeNode<Object>::ObjectContainer& objects = pending.node->objects;
+        auto object_it_before = objects.before_begin();
+        auto object_it = objects.begin();
+
+        while (object_it != objects.end()) {
+            Object* object = *object_it;
+
+            if (object == nullptr && cleanup) {
+                object_it = objects.erase_after(object_it_before);
+                continue;
+            }
+
+            object_it_before = object_it++;
+
+            if (object == nullptr) {
+                continue;
+            }
+
+            if (!free_ride) {
+                BoundingBoxExtractor::ExtractBoundingBody(object, &object_bounds);
+
+                if (!region.Intersects(object_bounds)) {
+                    continue;
+                }
+            }
+
+            if (visitor(object)) {
+                running_queries_--;
+                return true;
+            }
+        }
+
+        // cleaned up after its children
+        if (cleanup) {
+            PendingNode leaving = pending;
+            leaving.leaving = true;
+            stack[stack_size++] = leaving;
+        }
+
+        detail::TreeNode<Object>* node = pending.node;
+        const int depth = pending.depth + 1;
+        const Number left = pending.left;
+        const Number top = pending.top;
+        const Number half_width = (Number)((typename detail::MakeDistance<Number>::Type)pending.width / 2);
+        const Number half_height = (Number)((typename detail::MakeDistance<Number>::Type)pending.height / 2);
+        const Number right_width = (Number)(left + pending.width - (Number)(left + half_width));
+        const Number bottom_height = (Number)(top + pending.height - (Number)(top + half_height));
+
+        // pushed in reverse so they're visited in the same order as Query (top left first)
+        if (node->bottom_left != nullptr) {
+            stack[stack_size++] = {node->bottom_left, &node->bottom_left, left, (Number)(top + half_height), half_width, bottom_height, depth, free_ride, false};
+        }
+        if (node->bottom_right != nullptr) {
+            stack[stack_size++] = {node->bottom_right, &node->bottom_right, (Number)(left + half_width), (Number)(top + half_height), right_width, bottom_height, depth, free_ride, false};
+        }
+        if (node->top_right != nullptr) {
+            stack[stack_size++] = {node->top_right, &node->top_right, (Number)(left + half_width), top, right_width, half_height, depth, free_ride, false};
+        }
+        if (node->top_left != nullptr) {
+            stack[stack_size++] = {node->top_left, &node->top_left, left, top, half_width, half_height, depth, free_ride, false};
+        }
+    }
+
+    running_queries_--;
+    return false;
+}
+
+template <typename NumberT, typename ObjectT, typename BoundingBoxExtractorT>
+void
+    Quadtree<NumberT, ObjectT, BoundingBoxExtractorT>::Impl::
+CleanupNode(detail::TreeNode<Object>* node, detail::TreeNode<Object>** slot, int depth) {
+    // same as Query::Impl::Next when it leaves a node (only called if no other query is running)
+    assert(running_queries_ == 1);
+
+    // objects are moved up if the maximal depth decreased since they were inserted
+    // (they always go to an ancestor, which has already been visited)
+    if (depth > maximal_depth_) {
+        typename detail::TreeNode<Object>::ObjectContainer& objects = node->objects;
+
+        for (auto iterator = objects.begin(); iterator != objects.end(); ++iterator) {
+            if (*iterator != nullptr) {
+                Update(*iterator);
+                assert(*iterator == nullptr);
+            }
+        }
+
+        objects.clear();
+    }
+
+    if (!node->objects.empty() || node->top_left != nullptr || node->top_right != nullptr ||
+            node->bottom_right != nullptr || node->bottom_left != nullptr) {
+        return;
+    }
+
+    // the tree might have grown after an insertion inside the visitor
+    if (*slot != node) {
+        return;
+    }
+
+    if (node == root_) {
+        assert(GetSize() == 0);
+        assert(object_pointers_.size() == 0);
+
+        allocator_.Delete(root_);
+        root_ = nullptr;
+        bounding_box_ = BoundingBody<Number>();
+    } else {
+        *slot = nullptr;
+        allocator_.Delete(node);
+    }
+}
+
+template <typename NumberT, typename ObjectT, typename BoundingBoxExtractorT>
+int
+    Quadtree<NumberT, ObjectT, BoundingBoxExtractorT>::Impl::
+GetNodeCount() const {
+    if (root_ == nullptr) {
+        return 0;
+    }
+
+    std::vector<const detail::TreeNode<Object>*> nodes(1, root_);
+    int count = 0;
+
+    while (!nodes.empty()) {
+        const detail::TreeNode<Object>* node = nodes.back();
+        nodes.pop_back();
+        count++;
+
+        if (node->top_left != nullptr) nodes.push_back(node->top_left);
+        if (node->top_right != nullptr) nodes.push_back(node->top_right);
+        if (node->bottom_right != nullptr) nodes.push_back(node->bottom_right);
+        if (node->bottom_left != nullptr) nodes.push_back(node->bottom_left);
+    }
+
+    return count;
+}
+
 template <typename NumberT, typename ObjectT, typename BoundingBoxExtractorT>
 const BoundingBody<NumberT>&
     Quadtree<NumberT, ObjectT, BoundingBoxExtractorT>::Impl::
@@ -1261,6 +1472,28 @@ QueryContainsRegion(const BoundingBody<Number>& region) -> Query {
     return impl_.QueryContainsRegion(region);
 }
 
+template <typename NumberT, typename ObjectT, typename BoundingBoxExtractorT>
+template <typename Visitor>
+bool
+    Quadtree<NumberT, ObjectT, BoundingBoxExtractorT>::
+ForEachIntersecting(const BoundingBody<Number>& region, Visitor visitor) {
+    return impl_.ForEachIntersecting(region, visitor);
+}
+
+template <typename NumberT, typename ObjectT, typename BoundingBoxExtractorT>
+void
+    Quadtree<NumberT, ObjectT, BoundingBoxExtractorT>::
+CollectIntersecting(const BoundingBody<Number>& region, std::vector<Object*>& objects) {
+    objects.clear();
+
+    auto visitor = [&objects] (Object* object) -> bool {
+        objects.push_back(object);
+        return false;
+    };
+
+    impl_.ForEachIntersecting(region, visitor);
+}
+
 template <typename NumberT, typename ObjectT, typename BoundingBoxExtractorT>
 const BoundingBody<NumberT>&
     Quadtree<NumberT, ObjectT, BoundingBoxExtractorT>::
@@ -1282,6 +1515,13 @@ GetSize() const {
     return impl_.GetSize();
 }
 
+template <typename NumberT, typename ObjectT, typename BoundingBoxExtractorT>
+int
+    Quadtree<NumberT, ObjectT, BoundingBoxExtractorT>::
+GetNodeCount() const {
+    return impl_.GetNodeCount();
+}
+
 template <typename NumberT, typename ObjectT, typename BoundingBoxExtractorT>
 bool
     Quadtree<NumberT, ObjectT, BoundingBoxExtractorT>::
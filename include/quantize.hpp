@@ -0,0 +1,31 @@
+#pragma once
+
+#include "defines.hpp"
+#include "crcpacket.hpp"
+
+//Positions are sent as a fixed-point number of steps (each step is precision world units)
+//The size of the world decides if 16 or 32 bits are needed to send any position
+//Values that moved only a few steps since the baseline are sent as a signed 8 bit difference
+
+//world units of each step (when it's not specified in the json file)
+constexpr float DEFAULT_POSITION_PRECISION = 0.125f;
+
+struct QuantizedCoord {
+    s32 steps = 0;
+    s8 delta = 0;
+
+    bool changed = true;
+    bool isDelta = false;
+};
+
+s32 Quantize_toSteps(float value, float precision);
+float Quantize_fromSteps(s32 steps, float precision);
+
+//prevValue is nullptr if there is no baseline
+QuantizedCoord Quantize_coord(float value, const float* prevValue, float precision);
+
+//worldSize is the size of the world in the same axis as the coordinate
+void Quantize_packCoord(const QuantizedCoord& coord, u32 worldSize, float precision, CRCPacket& outPacket);
+
+//value has to contain the baseline value if isDelta is true
+void Quantize_loadCoord(float& value, bool isDelta, u32 worldSize, float precision, CRCPacket& inPacket);
@@ -4,31 +4,61 @@
 #include "bucket.hpp"
 #include "defines.hpp"
 #include "projectiles.hpp"
+#include "projectile_batch.hpp"
 
 #include "managers_context.hpp"
+#include "collision_manager.hpp"
 
 #include "entity.hpp"
 #include "entity_table.hpp"
 #include "unit.hpp"
+#include "snapshot_history.hpp"
+
+//extra distance when querying the broadphase for entities inside an interest region
+constexpr float INTEREST_QUERY_SLACK = 64.f;
 
 class EntityManager
 {
+public:
+    //time spent in each phase of the last update
+    //(only measured when a pointer is passed to update, used for benchmarking)
+    struct UpdateTimings {
+        sf::Time preUpdate;
+        sf::Time update;
+        sf::Time projectiles;
+        sf::Time postUpdate;
+    };
+
 public:
     EntityManager(const JsonParser* jsonParser);
-    EntityManager();
 
-    void update(sf::Time eTime);
+    void update(sf::Time eTime, UpdateTimings* timings = nullptr);
 
     Projectile* createProjectile(u8 projectileType, const Vector2& pos, float aimAngle, u8 teamId);
     Entity* createEntity(u8 entityType, const Vector2& pos, u8 teamId, u32 forcedUniqueId = 0);
 
-    void takeSnapshot(EntityManager* snapshot) const;
-    void packData(const EntityManager* snapshot, u8 teamId, u32 controlledEntityUniqueId, CRCPacket& outPacket) const;
+    //entities inside the region that are sent to the team
+    void queryInterestEntities(const sf::FloatRect& region, u8 teamId, std::vector<u32>& uniqueIds);
+
+    //projectiles inside the region
+    void queryInterestProjectiles(const sf::FloatRect& region, std::vector<u32>& uniqueIds) const;
+
+    //Each entity/projectile is packed on its own (starting at a new byte), so the same data
+    //can be appended to the snapshot of every client of the team that has the same baseline for it
+    //(prevState is nullptr if the client doesn't have it, and then it's sent in full)
+    void packEntity(u32 uniqueId, const EntityNetState* prevState, u8 teamId, CRCPacket& outPacket) const;
+    void packProjectile(u32 uniqueId, const ProjectileNetState* prevProj, u8 teamId, CRCPacket& outPacket) const;
+
+    //data that is only sent to the client controlling the entity
+    void packControlledData(u32 controlledEntityUniqueId, CRCPacket& outPacket) const;
 
     void allocateAll();
 
     void setManagersContext(const ManagersContext& managers);
 
+    //has to be called every time a new map is loaded (like in the collision manager)
+    void setWorldSize(const Vector2u& worldSize);
+
     static const Entity* getEntityData(u8 type);
     static void loadEntityData(const JsonParser* jsonParser);
 
@@ -38,10 +68,21 @@ public:
     Bucket<Projectile> projectiles;
 
 private:
+    bool _shouldSendEntity(const Entity* entity, u8 teamId, const sf::FloatRect& region) const;
     inline u32 _getNewUniqueId();
 
+    void _groupEntitiesByType();
+
     ManagersContext m_managers;
 
+    //entities that are not in the collision broadphase (like food), only used for interest queries
+    //they're not updated, so they can't move
+    CollisionManager m_interestGrid;
+
+    //reused every update to avoid allocations
+    ProjectileBatch m_projectileBatch;
+    std::vector<Entity*> m_entityGroups[ENTITY_MAX_TYPES];
+
     u32 m_lastUniqueId;
 
     static bool m_entitiesJsonLoaded;
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <vector>
+#include <SFML/System/Time.hpp>
+
+#include "defines.hpp"
+#include "net_state.hpp"
+#include "memory_stats.hpp"
+
+class EntityManager;
+
+//Fixed-size ring buffer with the network state of the latest snapshots
+//Entity records that don't change between two consecutive snapshots are shared
+//(reference counted) so memory scales with the number of changes instead of
+//the number of entities times the history size
+//Records are stored in one array per entity type, each one with the NetState of that type
+
+class SnapshotHistory
+{
+public:
+    struct Entry {
+        u32 uniqueId;
+        u8 entityType;
+        u32 recordIndex;
+    };
+
+    class Snapshot
+    {
+    public:
+        friend class SnapshotHistory;
+
+    public:
+        u32 getId() const;
+        sf::Time getWorldTime() const;
+
+        //nullptr if the entity/projectile didn't exist in this snapshot
+        const EntityNetState* getEntity(u32 uniqueId) const;
+        const ProjectileNetState* getProjectile(u32 uniqueId) const;
+
+        size_t getEntityCount() const;
+
+    private:
+        const Entry* findEntry(u32 uniqueId) const;
+
+        u32 m_id = 0;
+        sf::Time m_worldTime;
+
+        //both sorted by uniqueId
+        std::vector<Entry, TrackedAllocator<Entry, MEMORY_TAG_SNAPSHOT_HISTORY>> m_entities;
+        std::vector<ProjectileNetState, TrackedAllocator<ProjectileNetState, MEMORY_TAG_SNAPSHOT_HISTORY>> m_projectiles;
+
+        const SnapshotHistory* m_history = nullptr;
+    };
+
+public:
+    SnapshotHistory(size_t size = 64);
+
+    //removes all stored snapshots
+    void resize(size_t size);
+    void clear();
+
+    //ids have to be consecutive for the ring buffer to work
+    //(the oldest snapshot is overwritten)
+    const Snapshot& takeSnapshot(u32 snapshotId, const sf::Time& worldTime, const EntityManager& entityManager);
+
+    //nullptr if the snapshot doesn't exist or it has been overwritten
+    const Snapshot* find(u32 snapshotId) const;
+
+    size_t getSize() const;
+    size_t getRecordCount() const;
+
+private:
+    //NetStates of one entity type, one after the other
+    struct RecordPool {
+        size_t stateSize = 0;
+
+        //stateSize rounded up so all records are aligned
+        size_t stride = 0;
+
+        std::vector<char, TrackedAllocator<char, MEMORY_TAG_SNAPSHOT_HISTORY>> states;
+        std::vector<u32, TrackedAllocator<u32, MEMORY_TAG_SNAPSHOT_HISTORY>> refCounts;
+        std::vector<u32, TrackedAllocator<u32, MEMORY_TAG_SNAPSHOT_HISTORY>> freeRecords;
+
+        EntityNetState* at(u32 index);
+        const EntityNetState* at(u32 index) const;
+    };
+
+    u32 allocateRecord(u8 entityType, const EntityNetState* state);
+    void releaseSnapshot(Snapshot& snapshot);
+
+    std::vector<Snapshot> m_snapshots;
+
+    std::vector<RecordPool> m_recordPools;
+
+    //the state of each entity is taken here before comparing it with the previous snapshot
+    std::vector<char> m_scratchState;
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <SFML/System/Time.hpp>
+
+#include "defines.hpp"
+
+//Sleeps until the deadline of the next tick instead of busy waiting
+//Deadlines are absolute, so oversleeping once doesn't accumulate drift
+//The sleep is split in slices of (at most) the poll interval so incoming messages are still received
+
+class TickScheduler
+{
+public:
+    struct Stats {
+        u32 ticks = 0;
+
+        //ticks that started a whole tick late (or more)
+        u32 overruns = 0;
+
+        //delay between the deadline and the actual start of the tick
+        sf::Time totalJitter;
+        sf::Time maxJitter;
+    };
+
+public:
+    TickScheduler(const sf::Time& tickRate = sf::seconds(1.f/60.f), const sf::Time& pollInterval = sf::milliseconds(1));
+
+    void setTickRate(const sf::Time& tickRate);
+    const sf::Time& getTickRate() const;
+
+    void setPollInterval(const sf::Time& pollInterval);
+
+    //the first tick is due right away
+    void start();
+
+    //sleeps until the next tick is due or the poll interval ends
+    //returns true if a tick has to run now (more than one might be due if the server fell behind)
+    bool waitForTick();
+
+    const Stats& getStats() const;
+    void resetStats();
+
+    //monotonic time (not related to the world time)
+    static sf::Time now();
+
+private:
+    static void sleepUntil(const sf::Time& time);
+
+    sf::Time m_tickRate;
+    sf::Time m_pollInterval;
+
+    sf::Time m_nextTick;
+
+    Stats m_stats;
+};
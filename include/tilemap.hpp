@@ -5,6 +5,7 @@
 #include <list>
 #include "defines.hpp"
 #include "bounding_body.hpp"
+#include "paths.hpp"
 
 enum TileType {
     TILE_NONE  = 0b0001,
@@ -23,7 +24,8 @@ class TileMap
 public:
     TileMap(u16 tileSize = DEFAULT_TILE_SIZE, u16 tileScale = TILE_SCALE);
 
-    void loadFromFile(const std::string& filename);
+    //mapsPath can be changed for tools that don't run from the build folder
+    void loadFromFile(const std::string& filename, const std::string& mapsPath = MAPS_PATH);
     std::list<Vector2> loadSpawnPoints(const std::string& filename, const sf::Color& color);
 
     bool isColliding(u16 tileFlags, const Circlef& circle) const;
@@ -34,6 +36,10 @@ public:
 
     bool getCollidingTileRect(u16 tileFlags, const Circlef& circle, sf::FloatRect& tileRect) const;
 
+    //moving the circle from its center to end, only the tiles crossed are checked
+    //t is the fraction of the movement until the first tile of tileFlags is hit
+    bool sweepCircle(u16 tileFlags, const Circlef& circle, const Vector2& end, float& t) const;
+
     TileType getTile(u16 i, u16 j) const;
 
     Vector2u getSize() const;
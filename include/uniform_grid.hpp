@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+#include "bounding_body.hpp"
+#include "broadphase_proxy.hpp"
+#include "memory_stats.hpp"
+
+//Broadphase that splits the world in square cells of the same size
+//Each entity is stored in all the cells its circle touches, so moving it is O(1)
+//(most of the time it stays in the same cells and only its circle changes)
+//Positions outside the world are clamped to the cells in the border
+
+constexpr float DEFAULT_GRID_CELL_SIZE = 128.f;
+
+class UniformGrid
+{
+public:
+    UniformGrid();
+
+    UniformGrid(const UniformGrid&) = delete;
+    UniformGrid& operator=(const UniformGrid&) = delete;
+
+    //removes all the proxies (they have to be inserted again)
+    void resize(const Vector2u& worldSize, float cellSize);
+
+    //the circle of the proxy body is used
+    void insert(BroadphaseProxy* proxy);
+    void update(BroadphaseProxy* proxy);
+    void remove(BroadphaseProxy* proxy);
+    void clear();
+
+    //visitor(BroadphaseProxy* proxy) is called once for each proxy that intersects the region
+    //it returns true to stop the query (returns true if it was stopped)
+    template<typename Visitor>
+    bool forEachIntersecting(const BoundingBodyf& region, Visitor visitor) const;
+
+    float getCellSize() const;
+
+private:
+    template<typename T>
+    using GridVector = std::vector<T, TrackedAllocator<T, MEMORY_TAG_UNIFORM_GRID>>;
+
+    GridCellRange _getCellRange(const sf::FloatRect& bounds) const;
+    static bool _equals(const GridCellRange& lhs, const GridCellRange& rhs);
+
+    void _addToCells(BroadphaseProxy* proxy);
+    void _removeFromCells(BroadphaseProxy* proxy);
+
+    float m_cellSize;
+    int m_columns;
+    int m_rows;
+
+    GridVector<GridVector<BroadphaseProxy*>> m_cells;
+};
+
+#include "uniform_grid.inl"
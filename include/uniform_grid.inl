@@ -0,0 +1,37 @@
+#include "uniform_grid.hpp"
+
+template<typename Visitor>
+bool UniformGrid::forEachIntersecting(const BoundingBodyf& region, Visitor visitor) const
+{
+    sf::FloatRect bounds;
+
+    if (region.isCircle) {
+        bounds = sf::FloatRect(region.circle.center.x - region.circle.radius, region.circle.center.y - region.circle.radius,
+                               2.f * region.circle.radius, 2.f * region.circle.radius);
+    } else {
+        bounds = region.rect.getGlobalBounds();
+    }
+
+    const GridCellRange range = _getCellRange(bounds);
+
+    for (int y = range.top; y <= range.bottom; ++y) {
+        for (int x = range.left; x <= range.right; ++x) {
+            const auto& cell = m_cells[y * m_columns + x];
+
+            //the visitor might insert new entities in this cell
+            for (size_t i = 0; i < cell.size(); ++i) {
+                BroadphaseProxy* proxy = cell[i];
+
+                //entities in more than one cell are only checked
+                //in the first cell they share with the region
+                if (x != std::max(proxy->gridCells.left, range.left) || y != std::max(proxy->gridCells.top, range.top)) continue;
+
+                if (region.Intersects(BoundingBodyf(proxy->body.circle)) && visitor(proxy)) {
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+#include "defines.hpp"
+
+//Fixed number of threads that run the iterations of a loop in parallel
+//The calling thread also runs iterations and blocks until all of them are done
+
+class WorkerPool
+{
+public:
+    WorkerPool(size_t threadCount = 0);
+    ~WorkerPool();
+
+    //with 0 threads everything runs in the calling thread
+    void resize(size_t threadCount);
+    size_t getThreadCount() const;
+
+    //calls function(i) for each i in [0, count)
+    //(iterations can run in any order and in any thread)
+    void parallelFor(size_t count, const std::function<void(size_t)>& function);
+
+private:
+    void workerLoop(u32 generation);
+    void runJobs();
+    void stopWorkers();
+
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex;
+    std::condition_variable m_workCondition;
+    std::condition_variable m_doneCondition;
+
+    const std::function<void(size_t)>* m_function;
+    size_t m_jobCount;
+    std::atomic<size_t> m_nextJob;
+
+    //workers that haven't finished the current loop
+    size_t m_activeWorkers;
+
+    //increased every time there's a new loop to run
+    u32 m_generation;
+    bool m_stop;
+};
@@ -1,8 +1,53 @@
 #include "buff.hpp"
 
+#include <algorithm>
+
 #include "unit.hpp"
 #include "ability.hpp"
-#include "bit_stream.hpp"
+#include "entity_pool.hpp"
+
+//all buffs have to be included to know the size of the pool blocks
+#include "buffs/root_buff.hpp"
+#include "buffs/reveal_buff.hpp"
+#include "buffs/recharge_ability_buff.hpp"
+#include "buffs/storm_buff.hpp"
+#include "buffs/invis_buff.hpp"
+#include "buffs/stun_buff.hpp"
+#include "buffs/slow_buff.hpp"
+#include "buffs/silence_buff.hpp"
+#include "buffs/phased_buff.hpp"
+#include "buffs/lifesteal_buff.hpp"
+#include "buffs/fishing_gaunlet_buff.hpp"
+#include "buffs/meat_shield_buff.hpp"
+
+namespace {
+
+const size_t BUFF_SIZES[] = {
+    #define DoBuff(class_name, type, json_id) \
+        sizeof(class_name),
+    #include "buffs.inc"
+    #undef DoBuff
+};
+
+EntityPool* Buff_createPool()
+{
+    EntityPool* pool = new EntityPool();
+    pool->setBlockSize(*std::max_element(std::begin(BUFF_SIZES), std::end(BUFF_SIZES)));
+
+    return pool;
+}
+
+//buffs only exist in the server, so the pool is not shared between threads
+//It's never destroyed on purpose: the buff data (static) is allocated from it,
+//and it would be destroyed after the pool at exit
+EntityPool& Buff_getPool()
+{
+    static EntityPool* pool = Buff_createPool();
+
+    return *pool;
+}
+
+}
 
 u8 Buff::stringToType(const std::string& typeStr)
 {
@@ -16,6 +61,27 @@ u8 Buff::stringToType(const std::string& typeStr)
     return BUFF_NONE;
 }
 
+void* Buff::operator new(std::size_t size)
+{
+    //buffs that are not in buffs.inc might not fit in the blocks
+    if (size > Buff_getPool().getBlockSize()) {
+        return ::operator new(size);
+    }
+
+    return Buff_getPool().allocate();
+}
+
+void Buff::operator delete(void* ptr, std::size_t size)
+{
+    if (!ptr) return;
+
+    if (size > Buff_getPool().getBlockSize()) {
+        ::operator delete(ptr);
+    } else {
+        Buff_getPool().deallocate(ptr);
+    }
+}
+
 void Buff::loadFromJson(const rapidjson::Document& doc)
 {
     m_dead = false;
@@ -130,6 +196,11 @@ void Buff::setUnit(Unit* unit)
     m_unit = unit;
 }
 
+void Buff::onUnitCopied(const Unit&)
+{
+
+}
+
 void Buff::kill()
 {
     m_dead = true;
@@ -1,5 +1,8 @@
 #include "buff_holder_component.hpp"
 
+#include <type_traits>
+#include <algorithm>
+
 #include "unit.hpp"
 #include "ability.hpp"
 #include "projectiles.hpp"
@@ -18,8 +21,39 @@
 #include "buffs/fishing_gaunlet_buff.hpp"
 #include "buffs/meat_shield_buff.hpp"
 
+namespace {
+
+//a buff type overrides a callback if taking its address doesn't give a member of Buff
+#define BUFF_OVERRIDES(class_name, function_name, callback) \
+    (std::is_same<decltype(&class_name::function_name), decltype(&Buff::function_name)>::value ? 0 : BUFF_CALLBACK_##callback)
+
+template<typename T>
+constexpr u16 Buff_callbacksOf()
+{
+    return BUFF_OVERRIDES(T, onPreUpdate, PRE_UPDATE) |
+           BUFF_OVERRIDES(T, onUpdate, UPDATE) |
+           BUFF_OVERRIDES(T, onDeath, DEATH) |
+           BUFF_OVERRIDES(T, onTakeDamage, TAKE_DAMAGE) |
+           BUFF_OVERRIDES(T, onProjectileHit, PROJECTILE_HIT) |
+           BUFF_OVERRIDES(T, onDealDamage, DEAL_DAMAGE) |
+           BUFF_OVERRIDES(T, onBeHealed, BE_HEALED) |
+           BUFF_OVERRIDES(T, onHeal, HEAL) |
+           BUFF_OVERRIDES(T, onEntityKill, ENTITY_KILL) |
+           BUFF_OVERRIDES(T, onGetDamageMultiplier, GET_DAMAGE_MULTIPLIER) |
+           BUFF_OVERRIDES(T, onMovement, MOVEMENT) |
+           BUFF_OVERRIDES(T, onPrimaryFireCasted, PRIMARY_FIRE_CASTED) |
+           BUFF_OVERRIDES(T, onSecondaryFireCasted, SECONDARY_FIRE_CASTED) |
+           BUFF_OVERRIDES(T, onAltAbilityCasted, ALT_ABILITY_CASTED) |
+           BUFF_OVERRIDES(T, onUltimateCasted, ULTIMATE_CASTED);
+}
+
+#undef BUFF_OVERRIDES
+
+}
+
 bool BuffHolderComponent::m_buffsLoaded = false;
 std::unique_ptr<Buff> BuffHolderComponent::m_buffData[BUFF_MAX_TYPES];
+u16 BuffHolderComponent::m_buffCallbacks[BUFF_MAX_TYPES];
 
 void BuffHolderComponent::loadBuffData(const JsonParser* jsonParser)
 {
@@ -28,7 +62,8 @@ void BuffHolderComponent::loadBuffData(const JsonParser* jsonParser)
     #define DoBuff(class_name, type, json_id) \
         m_buffData[BUFF_##type] = std::unique_ptr<Buff>(new class_name()); \
         m_buffData[BUFF_##type]->loadFromJson(*jsonParser->getDocument(json_id)); \
-        m_buffData[BUFF_##type]->setBuffType(BUFF_##type);
+        m_buffData[BUFF_##type]->setBuffType(BUFF_##type); \
+        m_buffCallbacks[BUFF_##type] = Buff_callbacksOf<class_name>();
     #include "buffs.inc"
     #undef DoBuff
 
@@ -37,11 +72,15 @@ void BuffHolderComponent::loadBuffData(const JsonParser* jsonParser)
 
 BuffHolderComponent::BuffHolderComponent(BuffHolderComponent const& other)
 {
-
+    _copyBuffs(other);
 }
 
 BuffHolderComponent& BuffHolderComponent::operator=(BuffHolderComponent const& other)
 {
+    if (this != &other) {
+        _copyBuffs(other);
+    }
+
     return *this;
 }
 
@@ -50,12 +89,7 @@ Buff* BuffHolderComponent::addBuff(u8 buffType)
     if (!m_buffsLoaded) return nullptr;
     if (buffType == BUFF_NONE || buffType >= BUFF_MAX_TYPES) return nullptr;
 
-    m_buffs.emplace_back(m_buffData[buffType]->clone());
-
-    //safe as long as this class is only inherited by Unit (must be the case)
-    m_buffs.back()->setUnit(static_cast<Unit*>(this));
-
-    return m_buffs.back().get();
+    return _insertBuff(m_buffData[buffType]->clone());
 }
 
 Buff* BuffHolderComponent::addUniqueBuff(u8 buffType)
@@ -63,8 +97,8 @@ Buff* BuffHolderComponent::addUniqueBuff(u8 buffType)
     if (!m_buffsLoaded) return nullptr;
     if (buffType == BUFF_NONE || buffType >= BUFF_MAX_TYPES) return nullptr;
     
-    for (const auto& buff : m_buffs) {
-        if (buff->getType() == buffType) {
+    for (const BuffSlot& slot : m_buffs) {
+        if (slot.buff->getType() == buffType) {
             return nullptr;
         }
     }
@@ -74,27 +108,75 @@ Buff* BuffHolderComponent::addUniqueBuff(u8 buffType)
 
 void BuffHolderComponent::removeUniqueBuff(u8 buffType)
 {
-    for (const auto& buff : m_buffs) {
-        if (buff->getType() == buffType) {
-            buff->kill();
+    for (const BuffSlot& slot : m_buffs) {
+        if (slot.buff->getType() == buffType) {
+            slot.buff->kill();
             break;
         }
     }
 }
 
-#define FOR_ALL_BUFFS(function_string) \
-    for (auto& buff : m_buffs) { \
-        buff->function_string; \
+Buff* BuffHolderComponent::_insertBuff(Buff* buff)
+{
+    //safe as long as this class is only inherited by Unit (must be the case)
+    buff->setUnit(static_cast<Unit*>(this));
+
+    BuffSlot slot;
+    slot.buff = std::unique_ptr<Buff>(buff);
+    slot.callbacks = m_buffCallbacks[buff->getType()];
+
+    m_callbacks |= slot.callbacks;
+    m_buffs.push_back(std::move(slot));
+
+    return buff;
+}
+
+void BuffHolderComponent::_copyBuffs(const BuffHolderComponent& other)
+{
+    m_buffs.clear();
+    m_callbacks = 0;
+
+    for (const BuffSlot& slot : other.m_buffs) {
+        Buff* buff = _insertBuff(slot.buff->clone());
+
+        //some buffs point to things the unit owns (like abilities)
+        buff->onUnitCopied(static_cast<const Unit&>(other));
+    }
+}
+
+void BuffHolderComponent::_updateCallbacks()
+{
+    m_callbacks = 0;
+
+    for (const BuffSlot& slot : m_buffs) {
+        m_callbacks |= slot.callbacks;
+    }
+}
+
+//buffs can be added by the callbacks, so slots are accessed by index
+#define FOR_ALL_BUFFS(callback, function_string) \
+    if ((m_callbacks & BUFF_CALLBACK_##callback) == 0) return; \
+    \
+    for (size_t i = 0; i < m_buffs.size(); ++i) { \
+        if (m_buffs[i].callbacks & BUFF_CALLBACK_##callback) { \
+            m_buffs[i].buff->function_string; \
+        } \
     }
 
 void BuffHolderComponent::onTakeDamage(u16& damage, Entity* source, u32 uniqueId, u8 teamId)
 {
-    FOR_ALL_BUFFS(onTakeDamage(damage, source, uniqueId, teamId))
+    FOR_ALL_BUFFS(TAKE_DAMAGE, onTakeDamage(damage, source, uniqueId, teamId))
 }
 
 void BuffHolderComponent::onProjectileHit(Projectile& projectile, Entity* target)
 {
-    FOR_ALL_BUFFS(onProjectileHit(projectile, target))
+    if (m_callbacks & BUFF_CALLBACK_PROJECTILE_HIT) {
+        for (size_t i = 0; i < m_buffs.size(); ++i) {
+            if (m_buffs[i].callbacks & BUFF_CALLBACK_PROJECTILE_HIT) {
+                m_buffs[i].buff->onProjectileHit(projectile, target);
+            }
+        }
+    }
     
     if (projectile.damage > 0) {
         onDealDamage(projectile.damage, target);
@@ -103,78 +185,87 @@ void BuffHolderComponent::onProjectileHit(Projectile& projectile, Entity* target
 
 void BuffHolderComponent::onBeHealed(u16 amount, Entity* source)
 {
-    FOR_ALL_BUFFS(onBeHealed(amount, source))
+    FOR_ALL_BUFFS(BE_HEALED, onBeHealed(amount, source))
 }
 
 void BuffHolderComponent::onHeal(u16 amount, Entity* target)
 {
-    FOR_ALL_BUFFS(onHeal(amount, target))
+    FOR_ALL_BUFFS(HEAL, onHeal(amount, target))
 }
 
 void BuffHolderComponent::onEntityKill(Entity* target)
 {
-    FOR_ALL_BUFFS(onEntityKill(target))
+    FOR_ALL_BUFFS(ENTITY_KILL, onEntityKill(target))
 }
 
 void BuffHolderComponent::onPreUpdate(sf::Time eTime)
 {
-    auto it = m_buffs.begin();
+    //timers of all buffs are updated
+    //(callbacks can add, kill or dispatch to other buffs, so dead ones are only removed afterwards)
+    for (size_t i = 0; i < m_buffs.size(); ++i) {
+        m_buffs[i].buff->update(eTime);
 
-    while (it != m_buffs.end()) {
-        //update timer
-        (*it)->update(eTime);
+        if (m_buffs[i].buff->isDead()) continue;
 
-        if ((*it)->isDead()) {
-            it = m_buffs.erase(it);
-        } else {
-            (*it)->onPreUpdate(eTime);
-            it++;
+        if (m_buffs[i].callbacks & BUFF_CALLBACK_PRE_UPDATE) {
+            m_buffs[i].buff->onPreUpdate(eTime);
         }
     }
+
+    //dead buffs are removed keeping the order
+    auto it = std::remove_if(m_buffs.begin(), m_buffs.end(), [] (const BuffSlot& slot) {
+        return slot.buff->isDead();
+    });
+
+    if (it != m_buffs.end()) {
+        m_buffs.erase(it, m_buffs.end());
+        _updateCallbacks();
+    }
 }
 
 void BuffHolderComponent::onUpdate(sf::Time eTime)
 {
-    FOR_ALL_BUFFS(onUpdate(eTime))
+    FOR_ALL_BUFFS(UPDATE, onUpdate(eTime))
 }
 
 void BuffHolderComponent::onDeath(bool& dead)
 {
-    FOR_ALL_BUFFS(onDeath(dead))
+    FOR_ALL_BUFFS(DEATH, onDeath(dead))
 }
 
 void BuffHolderComponent::onGetDamageMultiplier(float& multiplier) const
 {
-    FOR_ALL_BUFFS(onGetDamageMultiplier(multiplier))
+    FOR_ALL_BUFFS(GET_DAMAGE_MULTIPLIER, onGetDamageMultiplier(multiplier))
 }
+
 void BuffHolderComponent::onMovement()
 {
-    FOR_ALL_BUFFS(onMovement())
+    FOR_ALL_BUFFS(MOVEMENT, onMovement())
 }
 
 void BuffHolderComponent::onPrimaryFireCasted()
 {
-    FOR_ALL_BUFFS(onPrimaryFireCasted())
+    FOR_ALL_BUFFS(PRIMARY_FIRE_CASTED, onPrimaryFireCasted())
 }
 
 void BuffHolderComponent::onSecondaryFireCasted()
 {
-    FOR_ALL_BUFFS(onSecondaryFireCasted())
+    FOR_ALL_BUFFS(SECONDARY_FIRE_CASTED, onSecondaryFireCasted())
 }
 
 void BuffHolderComponent::onAltAbilityCasted()
 {
-    FOR_ALL_BUFFS(onAltAbilityCasted())
+    FOR_ALL_BUFFS(ALT_ABILITY_CASTED, onAltAbilityCasted())
 }
 
 void BuffHolderComponent::onUltimateCasted()
 {
-    FOR_ALL_BUFFS(onUltimateCasted())
+    FOR_ALL_BUFFS(ULTIMATE_CASTED, onUltimateCasted())
 }
 
 void BuffHolderComponent::onDealDamage(u16 damage, Entity* target)
 {
-    FOR_ALL_BUFFS(onDealDamage(damage, target))
+    FOR_ALL_BUFFS(DEAL_DAMAGE, onDealDamage(damage, target))
 }
 
 // void BuffHolderComponent::onAbilityCasted(Ability* ability)
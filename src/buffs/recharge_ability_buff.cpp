@@ -2,7 +2,7 @@
 
 #include "ability.hpp"
 #include "game_mode.hpp"
-#include "entities/crate.hpp"
+#include "entity_capabilities.hpp"
 
 RechargeAbilityBuff* RechargeAbilityBuff::clone() const
 {
@@ -12,7 +12,7 @@ RechargeAbilityBuff* RechargeAbilityBuff::clone() const
 void RechargeAbilityBuff::onDealDamage(u16 damage, Entity* target)
 {
     //crates don't recharge abilities
-    if (m_ability && dynamic_cast<Crate*>(target) == nullptr) {
+    if (m_ability && Entity_getComponent<Crate>(target) == nullptr) {
         //by default (multiplier=1) 200 damage = 10% charge
         m_ability->addToPercentage((static_cast<float>(damage)/2000.f) * getMultiplier());
     }
@@ -32,6 +32,23 @@ void RechargeAbilityBuff::setParentAbility(RechargeAbility* ability, const Manag
     m_gameMode = context.gameMode;
 }
 
+void RechargeAbilityBuff::onUnitCopied(const Unit& prevUnit)
+{
+    //the ability has to be the one the new unit has in the same slot
+    if (m_ability == prevUnit.getSecondaryFire()) {
+        m_ability = static_cast<RechargeAbility*>(m_unit->getSecondaryFire());
+
+    } else if (m_ability == prevUnit.getAltAbility()) {
+        m_ability = static_cast<RechargeAbility*>(m_unit->getAltAbility());
+
+    } else if (m_ability == prevUnit.getUltimate()) {
+        m_ability = static_cast<RechargeAbility*>(m_unit->getUltimate());
+
+    } else {
+        m_ability = nullptr;
+    }
+}
+
 float RechargeAbilityBuff::getMultiplier() const
 {
     if (m_ability) {
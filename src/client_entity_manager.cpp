@@ -243,7 +243,8 @@ C_Projectile* C_EntityManager::createProjectile(u8 type, const Vector2& pos, flo
         return nullptr;
     }
 
-    u32 uniqueId = localLastUniqueId++;
+    //0 is not a valid uniqueId
+    u32 uniqueId = ++localLastUniqueId;
     int index = localProjectiles.addElement(uniqueId);
 
     C_Projectile& projectile = localProjectiles[index];
@@ -258,56 +259,91 @@ C_Projectile* C_EntityManager::createProjectile(u8 type, const Vector2& pos, flo
 
 void C_EntityManager::loadFromData(C_EntityManager* prevSnapshot, CRCPacket& inPacket, CasterSnapshot& casterSnapshot)
 {
+    const Vector2u worldSize = m_tileMap->getWorldSize();
+
+    //entities of the previous snapshot are kept unless the server removes them
+    //(entities that didn't fit in this snapshot are not sent)
+    if (prevSnapshot) {
+        for (auto it = prevSnapshot->entities.begin(); it != prevSnapshot->entities.end(); ++it) {
+            entities.addEntity(it->clone());
+        }
+    }
+
+    u16 removedNumber;
+    inPacket >> removedNumber;
+
+    for (int i = 0; i < removedNumber; ++i) {
+        u32 uniqueId;
+        inPacket.readVarUint(uniqueId);
+
+        entities.removeEntity(uniqueId);
+    }
+
     //number of units
     u16 entityNumber;
     inPacket >> entityNumber;
 
     for (int i = 0; i < entityNumber; ++i) {
-        u32 uniqueId;
-        inPacket >> uniqueId;
+        //each entity is packed starting at a new byte
+        inPacket.alignRead();
 
-        const C_Entity* prevEntity = nullptr;
-        
-        if (prevSnapshot) {
-            prevEntity = prevSnapshot->entities.atUniqueId(uniqueId);
-        }
-
-        //allocate the unit
+        u32 uniqueId;
+        inPacket.readVarUint(uniqueId);
 
-        C_Entity* entity = nullptr;
+        bool full;
+        inPacket >> full;
 
-        if (prevEntity) {
-            //if the unit existed in previous snapshot, copy it
-            entity = entities.addEntity(prevEntity->clone());
+        C_Entity* entity = entities.atUniqueId(uniqueId);
 
-        } else {
+        if (full) {
             u8 entityType;
             inPacket >> entityType;
-            
+
+            //the server doesn't have the data we have anymore
+            if (entity) {
+                entities.removeEntity(uniqueId);
+            }
+
             //otherwise initialize it
             entity = createEntity(entityType, uniqueId);
 
             //Entity creation callbacks might go here?
             //Or is it better to have them when the entity is rendered for the first time?
+
+        } else if (!entity) {
+            std::cout << "C_EntityManager::loadFromData error - Entity not found in the previous snapshot" << std::endl;
+            inPacket.clear();
+            return;
         }
 
         //in both cases it has to be loaded from packet
-        entity->loadFromData(getControlledEntityUniqueId(), inPacket, casterSnapshot);
+        entity->loadFromData(worldSize, inPacket, casterSnapshot);
     }
 
     u16 projectileNumber;
     inPacket >> projectileNumber;
 
     for (int i = 0; i < projectileNumber; ++i) {
+        inPacket.alignRead();
+
         u32 uniqueId;
-        inPacket >> uniqueId;
+        inPacket.readVarUint(uniqueId);
+
+        bool full;
+        inPacket >> full;
 
         C_Projectile* prevProj = nullptr;
 
-        if (prevSnapshot) {
+        if (!full && prevSnapshot) {
             prevProj = prevSnapshot->projectiles.atUniqueId(uniqueId);
         }
 
+        if (!full && !prevProj) {
+            std::cout << "C_EntityManager::loadFromData error - Projectile not found in the previous snapshot" << std::endl;
+            inPacket.clear();
+            return;
+        }
+
         int index = projectiles.addElement(uniqueId);
 
         if (prevProj) {
@@ -321,7 +357,16 @@ void C_EntityManager::loadFromData(C_EntityManager* prevSnapshot, CRCPacket& inP
             projectiles[index].uniqueId = uniqueId;
         }
 
-        C_Projectile_loadFromData(projectiles[index], inPacket);
+        C_Projectile_loadFromData(projectiles[index], worldSize, inPacket);
+    }
+
+    inPacket.alignRead();
+
+    //data only sent to us if we control the entity
+    C_Entity* controlledEntity = entities.atUniqueId(m_controlledEntityUniqueId);
+
+    if (controlledEntity) {
+        controlledEntity->loadControlledData(inPacket, casterSnapshot);
     }
 }
 
@@ -3,72 +3,197 @@
 #include <iostream>
 
 #include "quadtree.hpp"
+#include "entity.hpp"
 
-CollisionManager::CollisionManager()
+void BroadphaseProxyExtractor::ExtractBoundingBody(const BroadphaseProxy* in, BoundingBodyf* out)
+{
+    *out = in->body;
+}
+
+CollisionManager::CollisionManager(BroadphaseType broadphaseType):
+    m_broadphaseType(broadphaseType),
+    m_changeCount(0)
 {
     m_quadtree = std::unique_ptr<QuadtreeType>(new QuadtreeType());
 }
 
 CollisionManager::~CollisionManager()
 {
+    clear();
+}
 
+void CollisionManager::loadFromJson(const rapidjson::Document& doc)
+{
+    BroadphaseType broadphaseType = BROADPHASE_QUADTREE;
+    float cellSize = DEFAULT_GRID_CELL_SIZE;
+
+    //"quadtree" or "grid"
+    if (doc.HasMember("broadphase")) {
+        const std::string type = doc["broadphase"].GetString();
+
+        if (type == "grid") {
+            broadphaseType = BROADPHASE_UNIFORM_GRID;
+
+        } else if (type != "quadtree") {
+            std::cout << "CollisionManager::loadFromJson error - Unknown broadphase " << type << std::endl;
+        }
+    }
+
+    //should be at least the diameter of most units
+    if (doc.HasMember("broadphase_cell_size")) {
+        cellSize = doc["broadphase_cell_size"].GetFloat();
+    }
+
+    setBroadphaseType(broadphaseType, cellSize);
 }
 
-void CollisionManager::onInsertEntity(u32 uniqueId, const Vector2& pos, u8 radius)
+void CollisionManager::setBroadphaseType(BroadphaseType broadphaseType, float cellSize)
 {
-    Circlef circle(pos, (float) radius);
-    m_entities[uniqueId] = std::unique_ptr<QuadtreeEntityType>(new QuadtreeEntityType(uniqueId, circle));
+    if (!m_proxies.empty()) {
+        std::cout << "CollisionManager::setBroadphaseType error - Broadphase is not empty" << std::endl;
+        return;
+    }
+
+    m_broadphaseType = broadphaseType;
 
-    m_quadtree->Insert(m_entities[uniqueId].get());
+    m_grid.resize(m_worldSize, cellSize);
 }
 
-void CollisionManager::onUpdateEntity(u32 uniqueId, const Vector2& newPos, float newRadius)
+BroadphaseType CollisionManager::getBroadphaseType() const
 {
-    auto it = m_entities.find(uniqueId);
+    return m_broadphaseType;
+}
 
-    if (it != m_entities.end()) {
-        //minimizes the amount of calls to Quadtree::Update
-        bool needsUpdate = false;
+void CollisionManager::setWorldSize(const Vector2u& worldSize)
+{
+    m_worldSize = worldSize;
 
-        if (it->second->body.circle.center != newPos) {
-            it->second->body.circle.center = newPos;
-            needsUpdate = true;
-        }
+    if (m_broadphaseType == BROADPHASE_UNIFORM_GRID) {
+        m_grid.resize(worldSize, m_grid.getCellSize());
 
-        if (it->second->body.circle.radius != newRadius) {
-            it->second->body.circle.radius = newRadius;
-            needsUpdate = true;
+        for (BroadphaseProxy* proxy : m_proxies) {
+            m_grid.insert(proxy);
         }
+    }
+}
 
-        if (needsUpdate) {
-            m_quadtree->Update(it->second.get());
-        }
+void CollisionManager::onInsertEntity(Entity* entity)
+{
+    BroadphaseProxy* proxy = entity->getBroadphaseProxy();
+
+    proxy->entity = entity;
+    proxy->uniqueId = entity->getUniqueId();
+    proxy->teamId = entity->getTeamId();
+    proxy->solid = entity->isSolid();
+    proxy->body = BoundingBodyf(Circlef(entity->getPosition(), (float) entity->getCollisionRadius()));
+
+    insertProxy(proxy);
+}
 
+void CollisionManager::onUpdateEntity(Entity* entity)
+{
+    BroadphaseProxy* proxy = entity->getBroadphaseProxy();
+
+    if (proxy->collisionManager != this) {
+        std::cout << "CollisionManager::onUpdateEntity error - Entity is not in the broadphase" << std::endl;
+        return;
+    }
+
+    const Vector2& newPos = entity->getPosition();
+    const float newRadius = (float) entity->getCollisionRadius();
+
+    //minimizes the amount of calls to Quadtree::Update
+    if (proxy->body.circle.center != newPos || proxy->body.circle.radius != newRadius) {
+        proxy->body.circle.center = newPos;
+        proxy->body.circle.radius = newRadius;
+
+        updateProxy(proxy);
+    }
+}
+
+void CollisionManager::onDeleteEntity(Entity* entity)
+{
+    removeProxy(entity->getBroadphaseProxy());
+}
+
+void CollisionManager::insertProxy(BroadphaseProxy* proxy)
+{
+    if (proxy->collisionManager) {
+        std::cout << "CollisionManager::insertProxy error - Proxy is already in a broadphase" << std::endl;
+        return;
+    }
+
+    proxy->collisionManager = this;
+    proxy->index = m_proxies.size();
+    m_proxies.push_back(proxy);
+
+    m_changeCount++;
+
+    if (m_broadphaseType == BROADPHASE_UNIFORM_GRID) {
+        m_grid.insert(proxy);
     } else {
-        std::cout <<  "CollisionManager::onUpdateUnit error - UniqueId doesn't exist" << std::endl;
+        m_quadtree->Insert(proxy);
     }
 }
 
-void CollisionManager::onDeleteEntity(u32 uniqueId)
+void CollisionManager::updateProxy(BroadphaseProxy* proxy)
 {
-    auto it = m_entities.find(uniqueId);
+    m_changeCount++;
+
+    if (m_broadphaseType == BROADPHASE_UNIFORM_GRID) {
+        m_grid.update(proxy);
+    } else {
+        m_quadtree->Update(proxy);
+    }
+}
 
-    if (it != m_entities.end()) {
-        m_quadtree->Remove(it->second.get());
-        m_entities.erase(it);
+void CollisionManager::removeProxy(BroadphaseProxy* proxy)
+{
+    if (proxy->collisionManager != this) {
+        std::cout << "CollisionManager::removeProxy error - Proxy is not in this broadphase" << std::endl;
+        return;
+    }
 
+    if (m_broadphaseType == BROADPHASE_UNIFORM_GRID) {
+        m_grid.remove(proxy);
     } else {
-        std::cout <<  "CollisionManager::onDeleteUnit error - UniqueId doesn't exist" << std::endl;
+        m_quadtree->Remove(proxy);
     }
+
+    m_proxies[proxy->index] = m_proxies.back();
+    m_proxies[proxy->index]->index = proxy->index;
+    m_proxies.pop_back();
+
+    proxy->collisionManager = nullptr;
+
+    m_changeCount++;
 }
 
-void CollisionManager::clear()
+size_t CollisionManager::getSize() const
 {
-    m_quadtree->Clear();
-    m_entities.clear();
+    return m_proxies.size();
+}
+
+const std::vector<BroadphaseProxy*>& CollisionManager::getProxies() const
+{
+    return m_proxies;
+}
+
+u32 CollisionManager::getChangeCount() const
+{
+    return m_changeCount;
 }
 
-QuadtreeType* CollisionManager::getQuadtree()
+void CollisionManager::clear()
 {
-    return m_quadtree.get();
+    for (BroadphaseProxy* proxy : m_proxies) {
+        proxy->collisionManager = nullptr;
+    }
+
+    m_proxies.clear();
+
+    m_quadtree->Clear();
+    m_grid.clear();
+
+    m_changeCount++;
 }
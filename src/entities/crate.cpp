@@ -1,12 +1,11 @@
 #include "entities/crate.hpp"
 
 #include "helper.hpp"
-#include "bit_stream.hpp"
 #include "client_entity_manager.hpp"
 
 Crate* Crate::clone() const
 {
-    return new Crate(*this);
+    return new (m_type) Crate(*this);
 }
 
 void Crate::loadFromJson(const rapidjson::Document& doc)
@@ -48,31 +47,34 @@ void Crate::postUpdate(sf::Time eTime, const ManagersContext& context)
     checkDead(context);
 }
 
-void Crate::packData(const Entity* prevEntity, u8 teamId, u32 controlledEntityUniqueId, CRCPacket& outPacket) const
+void Crate::packData(const EntityNetState* prevState, u8 teamId, const Vector2u& worldSize, CRCPacket& outPacket) const
 {
-    const Crate* prevCrate = static_cast<const Crate*>(prevEntity);
+    const CrateNetState* prevCrate = static_cast<const CrateNetState*>(prevState);
 
-    bool posXChanged = !prevCrate || m_pos.x != prevCrate->getPosition().x;
-    outPacket << posXChanged;
+    QuantizedCoord posX = Quantize_coord(m_pos.x, prevState ? &prevState->pos.x : nullptr, m_positionPrecision);
+    outPacket << posX.changed;
 
-    bool posYChanged = !prevCrate || m_pos.y != prevCrate->getPosition().y;
-    outPacket << posYChanged;
+    QuantizedCoord posY = Quantize_coord(m_pos.y, prevState ? &prevState->pos.y : nullptr, m_positionPrecision);
+    outPacket << posY.changed;
 
-    bool teamIdChanged = !prevCrate || teamId != prevCrate->getTeamId();
+    bool teamIdChanged = !prevState || teamId != prevState->teamId;
     outPacket << teamIdChanged;
 
-    bool maxHealthChanged = !prevCrate || m_maxHealth != prevCrate->getMaxHealth();
+    bool maxHealthChanged = !prevState || m_maxHealth != prevCrate->maxHealth;
     outPacket << maxHealthChanged;
 
-    bool healthChanged = !prevCrate || m_health != prevCrate->getHealth();
+    bool healthChanged = !prevState || m_health != prevCrate->health;
     outPacket << healthChanged;
 
-    if (posXChanged) {
-        outPacket << m_pos.x;
+    outPacket << posX.isDelta;
+    outPacket << posY.isDelta;
+
+    if (posX.changed) {
+        Quantize_packCoord(posX, worldSize.x, m_positionPrecision, outPacket);
     }
 
-    if (posYChanged) {
-        outPacket << m_pos.y;
+    if (posY.changed) {
+        Quantize_packCoord(posY, worldSize.y, m_positionPrecision, outPacket);
     }
 
     if (teamIdChanged) {
@@ -88,6 +90,15 @@ void Crate::packData(const Entity* prevEntity, u8 teamId, u32 controlledEntityUn
     }
 }
 
+void Crate::takeNetState(EntityNetState& state) const
+{
+    Entity::takeNetState(state);
+
+    CrateNetState& crateState = static_cast<CrateNetState&>(state);
+    crateState.health = m_health;
+    crateState.maxHealth = m_maxHealth;
+}
+
 void Crate::onCreated()
 {
     const int possibleFoodDiff = m_maxPossibleFood - m_minPossibleFood;
@@ -117,7 +128,7 @@ void Crate::checkDead(const ManagersContext& context)
 
 C_Crate* C_Crate::clone() const
 {
-    return new C_Crate(*this);
+    return new (m_type) C_Crate(*this);
 }
 
 void C_Crate::loadFromJson(const rapidjson::Document& doc, u16 textureId, const Context& context)
@@ -132,26 +143,30 @@ void C_Crate::update(sf::Time eTime, const C_ManagersContext& context)
 
 }
 
-void C_Crate::loadFromData(u32 controlledEntityUniqueId, CRCPacket& inPacket, CasterSnapshot& casterSnapshot)
+void C_Crate::loadFromData(const Vector2u& worldSize, CRCPacket& inPacket, CasterSnapshot& casterSnapshot)
 {
     bool posXChanged;
     bool posYChanged;
     bool teamIdChanged;
     bool maxHealthChanged;
     bool healthChanged;
+    bool posXDelta;
+    bool posYDelta;
     
     inPacket >> posXChanged;
     inPacket >> posYChanged;
     inPacket >> teamIdChanged;
     inPacket >> maxHealthChanged;
     inPacket >> healthChanged;
+    inPacket >> posXDelta;
+    inPacket >> posYDelta;
 
     if (posXChanged) {
-        inPacket >> m_pos.x;
+        Quantize_loadCoord(m_pos.x, posXDelta, worldSize.x, m_positionPrecision, inPacket);
     }
 
     if (posYChanged) {
-        inPacket >> m_pos.y;
+        Quantize_loadCoord(m_pos.y, posYDelta, worldSize.y, m_positionPrecision, inPacket);
     }
 
     if (teamIdChanged) {
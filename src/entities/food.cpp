@@ -1,12 +1,12 @@
 #include "entities/food.hpp"
 
-#include "bit_stream.hpp"
 #include "texture_ids.hpp"
 #include "collision_manager.hpp"
 #include "quadtree.hpp"
 #include "server_entity_manager.hpp"
 #include "client_entity_manager.hpp"
 #include "hero.hpp"
+#include "entity_capabilities.hpp"
 #include "tilemap.hpp"
 
 FoodRarityType FoodBase::m_rarityType[MAX_FOOD_TYPES];
@@ -181,7 +181,7 @@ void FoodBase::loadFoodData(const rapidjson::Document& doc)
 
 Food* Food::clone() const
 {
-    return new Food(*this);
+    return new (m_type) Food(*this);
 }
 
 void Food::loadFromJson(const rapidjson::Document& doc)
@@ -199,25 +199,17 @@ void Food::update(sf::Time eTime, const ManagersContext& context)
     if (m_dead) true;
 
     Circlef circle(getPosition(), getCollisionRadius());
-    auto query = context.collisionManager->getQuadtree()->QueryIntersectsRegion(BoundingBody<float>(circle));
-
-    while (!query.EndOfQuery()) {
-        Entity* entity = context.entityManager->entities.atUniqueId(query.GetCurrent()->uniqueId);
-
-        if (m_dead || !entity) {
-            query.Next();
-            continue;
-        }
-
-        Hero* hero = dynamic_cast<Hero*>(entity);
+    context.collisionManager->forEachIntersecting(BoundingBody<float>(circle), [&] (const BroadphaseProxy& proxy) -> bool {
+        Hero* hero = Entity_getComponent<Hero>(proxy.entity);
 
         if (hero) {
             hero->consumeFood(getFoodType());
             m_dead = true;
         }
 
-        query.Next();
-    }
+        //food can only be eaten once
+        return m_dead;
+    });
 }
 
 void Food::preUpdate(sf::Time eTime, const ManagersContext& context)
@@ -230,28 +222,31 @@ void Food::postUpdate(sf::Time eTime, const ManagersContext& context)
 
 }
 
-void Food::packData(const Entity* prevEntity, u8 teamId, u32 controlledEntityUniqueId, CRCPacket& outPacket) const
+void Food::packData(const EntityNetState* prevState, u8 teamId, const Vector2u& worldSize, CRCPacket& outPacket) const
 {
     outPacket << m_foodType;
 
-    bool posXChanged = !prevEntity || m_pos.x != prevEntity->getPosition().x;
-    outPacket << posXChanged;
+    QuantizedCoord posX = Quantize_coord(m_pos.x, prevState ? &prevState->pos.x : nullptr, m_positionPrecision);
+    outPacket << posX.changed;
 
-    bool posYChanged = !prevEntity || m_pos.y != prevEntity->getPosition().y;
-    outPacket << posYChanged;
+    QuantizedCoord posY = Quantize_coord(m_pos.y, prevState ? &prevState->pos.y : nullptr, m_positionPrecision);
+    outPacket << posY.changed;
 
-    if (posXChanged) {
-        outPacket << m_pos.x;
+    outPacket << posX.isDelta;
+    outPacket << posY.isDelta;
+
+    if (posX.changed) {
+        Quantize_packCoord(posX, worldSize.x, m_positionPrecision, outPacket);
     }
 
-    if (posYChanged) {
-        outPacket << m_pos.y;
+    if (posY.changed) {
+        Quantize_packCoord(posY, worldSize.y, m_positionPrecision, outPacket);
     }
 }
 
 C_Food* C_Food::clone() const
 {
-    return new C_Food(*this);
+    return new (m_type) C_Food(*this);
 }
 
 void C_Food::loadFromJson(const rapidjson::Document& doc, u16 textureId, const Context& context)
@@ -266,7 +261,7 @@ void C_Food::update(sf::Time eTime, const C_ManagersContext& context)
 
 }
 
-void C_Food::loadFromData(u32 controlledEntityUniqueId, CRCPacket& inPacket, CasterSnapshot& casterSnapshot)
+void C_Food::loadFromData(const Vector2u& worldSize, CRCPacket& inPacket, CasterSnapshot& casterSnapshot)
 {
     u8 prevFoodType = m_foodType;
     inPacket >> m_foodType;
@@ -277,16 +272,20 @@ void C_Food::loadFromData(u32 controlledEntityUniqueId, CRCPacket& inPacket, Cas
     
     bool posXChanged;
     bool posYChanged;
+    bool posXDelta;
+    bool posYDelta;
 
     inPacket >> posXChanged;
     inPacket >> posYChanged;
+    inPacket >> posXDelta;
+    inPacket >> posYDelta;
 
     if (posXChanged) {
-        inPacket >> m_pos.x;
+        Quantize_loadCoord(m_pos.x, posXDelta, worldSize.x, m_positionPrecision, inPacket);
     }
 
     if (posYChanged) {
-        inPacket >> m_pos.y;
+        Quantize_loadCoord(m_pos.y, posYDelta, worldSize.y, m_positionPrecision, inPacket);
     }
 }
 
@@ -3,6 +3,8 @@
 #include <SFML/Graphics/Sprite.hpp>
 #include "helper.hpp"
 #include "client_entity_manager.hpp"
+#include "entity_pool.hpp"
+#include "collision_manager.hpp"
 
 u32 BaseEntityComponent::getUniqueId() const
 {
@@ -96,6 +98,11 @@ bool BaseEntityComponent::canCollide(const BaseEntityComponent& otherEntity) con
     return m_uniqueId != otherEntity.m_uniqueId && m_solid && otherEntity.m_solid;
 }
 
+float BaseEntityComponent::getPositionPrecision() const
+{
+    return m_positionPrecision;
+}
+
 void BaseEntityComponent::loadFromJson(const rapidjson::Document& doc)
 {
     m_teamId = 0;
@@ -115,6 +122,40 @@ void BaseEntityComponent::loadFromJson(const rapidjson::Document& doc)
     } else {
         m_solid = false;
     }
+
+    if (doc.HasMember("position_precision")) {
+        m_positionPrecision = doc["position_precision"].GetFloat();
+    } else {
+        m_positionPrecision = DEFAULT_POSITION_PRECISION;
+    }
+}
+
+Entity::~Entity()
+{
+    if (m_broadphaseProxy.collisionManager) {
+        m_broadphaseProxy.collisionManager->removeProxy(&m_broadphaseProxy);
+    }
+}
+
+void* Entity::operator new(std::size_t size)
+{
+    //not from a pool (used by the entity data loaded from json)
+    return EntityPool_allocate(false, ENTITY_MAX_TYPES, size);
+}
+
+void* Entity::operator new(std::size_t size, u8 entityType)
+{
+    return EntityPool_allocate(false, entityType, size);
+}
+
+void Entity::operator delete(void* ptr)
+{
+    EntityPool_deallocate(ptr);
+}
+
+void Entity::operator delete(void* ptr, u8)
+{
+    EntityPool_deallocate(ptr);
 }
 
 void Entity::loadFromJson(const rapidjson::Document& doc)
@@ -129,6 +170,22 @@ void Entity::onCreated()
 
 }
 
+void Entity::takeNetState(EntityNetState& state) const
+{
+    state.uniqueId = m_uniqueId;
+    state.type = m_type;
+
+    state.pos = m_pos;
+    state.teamId = m_teamId;
+    state.collisionRadius = m_collisionRadius;
+    state.flyingHeight = m_flyingHeight;
+}
+
+void Entity::packControlledData(CRCPacket& outPacket) const
+{
+
+}
+
 bool Entity::shouldSendToTeam(u8 teamId) const
 {
     return true;
@@ -149,6 +206,43 @@ bool Entity::isDead() const
     return m_dead;
 }
 
+void Entity::setTeamId(u8 teamId)
+{
+    BaseEntityComponent::setTeamId(teamId);
+    m_broadphaseProxy.teamId = teamId;
+}
+
+void Entity::setSolid(bool solid)
+{
+    BaseEntityComponent::setSolid(solid);
+    m_broadphaseProxy.solid = solid;
+}
+
+BroadphaseProxy* Entity::getBroadphaseProxy()
+{
+    return &m_broadphaseProxy;
+}
+
+void* C_Entity::operator new(std::size_t size)
+{
+    return EntityPool_allocate(true, ENTITY_MAX_TYPES, size);
+}
+
+void* C_Entity::operator new(std::size_t size, u8 entityType)
+{
+    return EntityPool_allocate(true, entityType, size);
+}
+
+void C_Entity::operator delete(void* ptr)
+{
+    EntityPool_deallocate(ptr);
+}
+
+void C_Entity::operator delete(void* ptr, u8)
+{
+    EntityPool_deallocate(ptr);
+}
+
 void C_Entity::loadFromJson(const rapidjson::Document& doc, u16 textureId, const Context& context)
 {
     BaseEntityComponent::loadFromJson(doc);
@@ -184,6 +278,11 @@ void C_Entity::loadFromJson(const rapidjson::Document& doc, u16 textureId, const
     }
 }
 
+void C_Entity::loadControlledData(CRCPacket& inPacket, CasterSnapshot& casterSnapshot)
+{
+
+}
+
 void C_Entity::updateControlledAngle(float newAngle)
 {
 
@@ -0,0 +1,176 @@
+#include "entity_pool.hpp"
+
+#include <iostream>
+#include <algorithm>
+#include <cstddef>
+#include <new>
+
+#include "entity.hpp"
+#include "memory_stats.hpp"
+
+//all entities have to be included
+#include "hero.hpp"
+#include "entities/food.hpp"
+#include "entities/crate.hpp"
+
+namespace {
+
+//each allocation starts with a header that says where it came from
+//(its size keeps the object aligned)
+struct alignas(std::max_align_t) AllocationHeader {
+    bool client;
+    u8 entityType;
+};
+
+const size_t SERVER_ENTITY_SIZES[] = {
+    #define DoEntity(class_name, type, json_id) \
+        sizeof(class_name),
+    #include "entities.inc"
+    #undef DoEntity
+};
+
+const size_t CLIENT_ENTITY_SIZES[] = {
+    #define DoEntity(class_name, type, json_id) \
+        sizeof(C_##class_name),
+    #include "entities.inc"
+    #undef DoEntity
+};
+
+const char* ENTITY_TYPE_NAMES[] = {
+    #define DoEntity(class_name, type, json_id) \
+        #type,
+    #include "entities.inc"
+    #undef DoEntity
+};
+
+bool EntityPool_setupPools(EntityPool pools[2][ENTITY_MAX_TYPES])
+{
+    for (u8 i = 0; i < ENTITY_MAX_TYPES; ++i) {
+        pools[0][i].setBlockSize(sizeof(AllocationHeader) + SERVER_ENTITY_SIZES[i]);
+        pools[1][i].setBlockSize(sizeof(AllocationHeader) + CLIENT_ENTITY_SIZES[i]);
+    }
+
+    return true;
+}
+
+EntityPool& EntityPool_get(bool client, u8 entityType)
+{
+    static EntityPool pools[2][ENTITY_MAX_TYPES];
+
+    //static initialization is thread safe (server and client might run in different threads)
+    static const bool setup = EntityPool_setupPools(pools);
+    (void) setup;
+
+    return pools[client][entityType];
+}
+
+}
+
+EntityPool::EntityPool()
+{
+    m_blockSize = 0;
+}
+
+EntityPool::~EntityPool()
+{
+    MemoryStats_deallocate(MEMORY_TAG_ENTITY_POOLS, m_chunks.size() * m_blockSize * BLOCKS_PER_CHUNK);
+}
+
+void EntityPool::setBlockSize(size_t blockSize)
+{
+    //every block has to be aligned
+    const size_t alignment = alignof(std::max_align_t);
+    m_blockSize = (blockSize + alignment - 1)/alignment * alignment;
+}
+
+size_t EntityPool::getBlockSize() const
+{
+    return m_blockSize;
+}
+
+void* EntityPool::allocate()
+{
+    if (m_freeBlocks.empty()) {
+        //new char[] is aligned for any object that fits in it
+        m_chunks.emplace_back(new char[m_blockSize * BLOCKS_PER_CHUNK]);
+        MemoryStats_allocate(MEMORY_TAG_ENTITY_POOLS, m_blockSize * BLOCKS_PER_CHUNK);
+
+        char* chunk = m_chunks.back().get();
+
+        //the first blocks of the chunk are used first
+        for (size_t i = BLOCKS_PER_CHUNK; i > 0; --i) {
+            m_freeBlocks.push_back(chunk + (i - 1) * m_blockSize);
+        }
+
+        m_stats.free += BLOCKS_PER_CHUNK;
+    }
+
+    void* block = m_freeBlocks.back();
+    m_freeBlocks.pop_back();
+
+    m_stats.free--;
+    m_stats.live++;
+    m_stats.peak = std::max(m_stats.peak, m_stats.live);
+
+    return block;
+}
+
+void EntityPool::deallocate(void* block)
+{
+    m_freeBlocks.push_back(block);
+
+    m_stats.free++;
+    m_stats.live--;
+}
+
+const EntityPool::Stats& EntityPool::getStats() const
+{
+    return m_stats;
+}
+
+void* EntityPool_allocate(bool client, u8 entityType, size_t size)
+{
+    AllocationHeader* header;
+
+    if (entityType < ENTITY_MAX_TYPES && sizeof(AllocationHeader) + size <= EntityPool_get(client, entityType).getBlockSize()) {
+        header = static_cast<AllocationHeader*>(EntityPool_get(client, entityType).allocate());
+        header->entityType = entityType;
+
+    } else {
+        header = static_cast<AllocationHeader*>(::operator new(sizeof(AllocationHeader) + size));
+        header->entityType = ENTITY_MAX_TYPES;
+    }
+
+    header->client = client;
+
+    return header + 1;
+}
+
+void EntityPool_deallocate(void* ptr)
+{
+    if (!ptr) return;
+
+    AllocationHeader* header = static_cast<AllocationHeader*>(ptr) - 1;
+
+    if (header->entityType < ENTITY_MAX_TYPES) {
+        EntityPool_get(header->client, header->entityType).deallocate(header);
+    } else {
+        ::operator delete(header);
+    }
+}
+
+const EntityPool::Stats& EntityPool_getStats(bool client, u8 entityType)
+{
+    return EntityPool_get(client, entityType).getStats();
+}
+
+void EntityPool_printStats(bool client)
+{
+    std::cout << (client ? "Client" : "Server") << " entity pools (live/free/peak):" << std::endl;
+
+    for (u8 i = 0; i < ENTITY_MAX_TYPES; ++i) {
+        const EntityPool::Stats& stats = EntityPool_getStats(client, i);
+
+        std::cout << "    " << ENTITY_TYPE_NAMES[i] << ": " << stats.live << "/" << stats.free << "/" << stats.peak << std::endl;
+    }
+}
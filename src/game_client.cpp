@@ -5,6 +5,7 @@
 #include "helper.hpp"
 #include "game_mode_loader.hpp"
 #include "texture_ids.hpp"
+#include "entity_capabilities.hpp"
 
 GameClientCallbacks::GameClientCallbacks(GameClient* p)
 {
@@ -244,7 +245,7 @@ void GameClient::setupNextInterpolation()
     if (!m_clientCaster.getCaster() || (controlledEntityId != snapshotEntityId)) {
         //if for some reason controlled entity is not a unit the ClientCaster will
         //receive nullptr and nothing will change
-        C_Unit* controlledUnit = dynamic_cast<C_Unit*>(m_entityManager.entities.atUniqueId(controlledEntityId));
+        C_Unit* controlledUnit = C_Entity_getComponent<C_Unit>(m_entityManager.entities.atUniqueId(controlledEntityId));
         
         if (controlledUnit) {
             m_clientCaster.setCaster(controlledUnit, m_gameMode.get());
@@ -488,6 +489,9 @@ void GameClient::sendInitialInfo()
 
     outPacket << (u8) ServerCommand::PickedHero << m_pickedHero;
 
+    //so the server knows how far in the past we render other entities
+    outPacket << (u8) ServerCommand::ChangeRequiredSnapshotsToRender << (u8) m_requiredSnapshotsToRender;
+
     if (!m_displayName.empty()) {
         outPacket << (u8) ServerCommand::DisplayName << m_displayName;
     }
@@ -553,6 +557,7 @@ void GameClient::handleCommand(u8 command, CRCPacket& packet)
             Snapshot& snapshot = m_snapshots.back();
             snapshot.id = snapshotId;
             snapshot.entityManager.setControlledEntityUniqueId(controlledEntityUniqueId);
+            snapshot.entityManager.setTileMap(&m_tileMap);
             snapshot.entityManager.loadFromData(prevEntityManager, packet, snapshot.caster);
             snapshot.worldTime = m_worldTime;
             snapshot.latestAppliedInput = appliedPlayerInputId;
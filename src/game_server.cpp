@@ -8,10 +8,61 @@
 #include "player_input.hpp"
 #include "helper.hpp"
 #include "game_mode_loader.hpp"
+#include "memory_stats.hpp"
 
 //@DELETE
 #include "entities/food.hpp"
 
+#include <algorithm>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#endif // _WIN32
+
+namespace {
+
+//priority of entities the client doesn't have yet
+//(as if they hadn't been sent for this long)
+const sf::Time NEW_ENTITY_PRIORITY_TIME = sf::seconds(1.f);
+
+//the tick stats are logged this often (if some tick started late)
+const sf::Time TICK_STATS_INTERVAL = sf::seconds(60.f);
+
+//entities at the edge of the interest region have this fraction of the priority of close ones
+constexpr float MIN_DISTANCE_PRIORITY = 0.25f;
+
+//prevSnapshotId is stored relative to the latest snapshot (it's always inside the snapshot history)
+u64 ChunkKey_make(u32 uniqueId, bool projectile, u8 teamId, u32 prevSnapshotAge)
+{
+    return (static_cast<u64>(uniqueId) << 32) | (static_cast<u64>(teamId) << 24) |
+           (static_cast<u64>(projectile) << 23) | (prevSnapshotAge & 0x7fffff);
+}
+
+bool SnapshotItem_compare(const GameServer::SnapshotItem& lhs, const GameServer::SnapshotItem& rhs)
+{
+    if (lhs.required != rhs.required) return lhs.required;
+
+    return lhs.priority > rhs.priority;
+}
+
+bool ReceivedEntity_lessThan(const GameServer::ReceivedEntity& lhs, u32 uniqueId)
+{
+    return lhs.uniqueId < uniqueId;
+}
+
+const GameServer::ReceivedEntity* ClientView_findEntity(const GameServer::ClientView& view, u32 uniqueId)
+{
+    auto it = std::lower_bound(view.entities.begin(), view.entities.end(), uniqueId, ReceivedEntity_lessThan);
+
+    if (it == view.entities.end() || it->uniqueId != uniqueId) return nullptr;
+
+    return &(*it);
+}
+
+}
+
 GameServerCallbacks::GameServerCallbacks(GameServer* p)
 {
     parent = p;
@@ -108,7 +159,10 @@ GameServer::GameServer(const Context& context, u8 gameModeType):
     m_gameStarted = false;
     m_lastClientId = 0;
     m_lastSnapshotId = 0;
+    m_chunkCount = 0;
+    m_pendingSnapshotCount = 0;
     m_gameEnded = false;
+    m_consoleClosed = false;
 
     const rapidjson::Document& doc = *context.jsonParser->getDocument("server_config");
 
@@ -123,6 +177,8 @@ GameServer::GameServer(const Context& context, u8 gameModeType):
     m_entityManager.allocateAll();
 
     m_tileMap.loadFromFile(m_gameMode->getLobbyMapFilename());
+    m_collisionManager.setWorldSize(m_tileMap.getWorldSize());
+    m_entityManager.setWorldSize(m_tileMap.getWorldSize());
 
     if (!context.local) {
         m_pollId = createListenSocket(m_endpoint);
@@ -165,38 +221,122 @@ GameServer::~GameServer()
 
 void GameServer::mainLoop(bool& running)
 {
-    sf::Clock clock;
+    m_tickScheduler.setTickRate(m_updateRate);
+    m_tickScheduler.start();
 
-    sf::Time updateTimer;
-    sf::Time snapshotTimer;
+    sf::Time statsTimer;
+    sf::Time memoryTimer;
 
     while (running) {
-        sf::Time eTime = clock.restart();
+        receiveLoop();
+        handleConsoleInput();
 
-        updateTimer += eTime;
-        snapshotTimer += eTime;
+        //sleeps until the next update (waking up to receive messages)
+        if (!m_tickScheduler.waitForTick()) continue;
 
-        receiveLoop();
+        update(m_updateRate, running);
 
-        if (updateTimer >= m_updateRate) {
-            update(m_updateRate, running);
-            updateTimer -= m_updateRate;
-        }
+        //each client has its own snapshot timer
+        //(the world only changes after an update so there's no point in checking it more often)
+        sendSnapshots(m_updateRate);
+
+        statsTimer += m_updateRate;
 
-        //@TODO: Send snapshots at different rates for different clients
-        //(if m_canClientsChangeSnapshotRate == true)
-        if (snapshotTimer >= m_snapshotRate) {
-            sendSnapshots();
-            snapshotTimer -= m_snapshotRate;
+        //only logged if there were problems
+        if (statsTimer >= TICK_STATS_INTERVAL) {
+            if (m_tickScheduler.getStats().overruns > 0) {
+                printTickStats();
+            }
+
+            m_tickScheduler.resetStats();
+            statsTimer = sf::Time::Zero;
         }
 
-        //Remove this for maximum performance (more CPU usage)
-        // std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        memoryTimer += m_updateRate;
+
+        if (m_memoryLogInterval != sf::Time::Zero && memoryTimer >= m_memoryLogInterval) {
+            printMessage("Memory - %s", MemoryStats_summary().c_str());
+            memoryTimer = sf::Time::Zero;
+        }
     }
 
+    printTickStats();
+
     printMessage("Main loop ended");
 }
 
+void GameServer::printTickStats() const
+{
+    const TickScheduler::Stats& stats = m_tickScheduler.getStats();
+
+    if (stats.ticks == 0) return;
+
+    printMessage("Tick stats - Ticks: %u, overruns: %u, mean jitter: %.3f ms, max jitter: %.3f ms", stats.ticks, stats.overruns,
+                 stats.totalJitter.asSeconds() * 1000.f/stats.ticks, stats.maxJitter.asSeconds() * 1000.f);
+}
+
+void GameServer::handleConsoleInput()
+{
+#ifndef _WIN32
+    //the local server shares the console with the client
+    if (m_context.local || m_consoleClosed) return;
+
+    pollfd stdinPoll;
+    stdinPoll.fd = STDIN_FILENO;
+    stdinPoll.events = POLLIN;
+
+    while (poll(&stdinPoll, 1, 0) > 0) {
+        //stdin is not open (it's not readable after a hang up once everything is read)
+        if ((stdinPoll.revents & POLLIN) == 0) {
+            if (stdinPoll.revents & (POLLHUP | POLLERR | POLLNVAL)) {
+                m_consoleClosed = true;
+            }
+
+            return;
+        }
+
+        char buffer[256];
+        const ssize_t size = read(STDIN_FILENO, buffer, sizeof(buffer));
+
+        //EOF stays readable forever (when the server is run detached, for example)
+        if (size == 0 || (size < 0 && errno != EINTR && errno != EAGAIN)) {
+            m_consoleClosed = true;
+            return;
+        }
+
+        if (size < 0) return;
+
+        for (ssize_t i = 0; i < size; ++i) {
+            if (buffer[i] == '\n') {
+                handleConsoleCommand(m_consoleLine);
+                m_consoleLine.clear();
+
+            } else if (buffer[i] != '\r') {
+                m_consoleLine += buffer[i];
+            }
+        }
+    }
+#endif // _WIN32
+}
+
+void GameServer::handleConsoleCommand(const std::string& command)
+{
+    if (command.empty()) return;
+
+    if (command == "memory") {
+        MemoryStats_print();
+
+    } else if (command == "tick") {
+        printTickStats();
+
+    } else if (command == "help") {
+        printMessage("Commands - memory: memory usage of each subsystem, tick: tick stats");
+
+    } else {
+        printMessage("Unknown command '%s' (type help to list the commands)", command.c_str());
+    }
+}
+
 void GameServer::receiveLoop()
 {
     if (m_context.local) {
@@ -236,6 +376,9 @@ void GameServer::update(const sf::Time& eTime, bool& running)
             m_entityManager.entities.clear();
             m_entityManager.projectiles.clear();
             m_collisionManager.clear();
+            m_collisionManager.setWorldSize(m_tileMap.getWorldSize());
+            m_entityManager.setWorldSize(m_tileMap.getWorldSize());
+            m_lagCompensation.clear();
 
             m_gameMode->startGame();
 
@@ -322,69 +465,371 @@ void GameServer::update(const sf::Time& eTime, bool& running)
     }
 
     m_entityManager.update(eTime);
+
+    m_lagCompensation.record(m_worldTime, m_collisionManager);
     
     handleDeadHeroes();
     //@TODO: handleRespawnedHeroes
 }
 
-void GameServer::sendSnapshots()
+void GameServer::sendSnapshots(const sf::Time& eTime)
 {
-    //will store oldest snapshot used by clients
-    u32 oldestSnapshotId = -1;
+    //the snapshot is only taken if at least one client needs it this update
+    const SnapshotHistory::Snapshot* snapshot = nullptr;
 
-    //Take current snapshot
-    u32 snapshotId = ++m_lastSnapshotId;
-    Snapshot& snapshot = m_snapshots.emplace(snapshotId, Snapshot()).first->second;
+    //encoded data from previous updates is no longer valid
+    m_chunkCount = 0;
+    m_chunkIndices.clear();
+    m_pendingSnapshotCount = 0;
 
-    snapshot.worldTime = m_worldTime;
-    snapshot.id = snapshotId;
+    for (int i = 0; i < m_clients.firstInvalidIndex(); ++i) {
+        ClientInfo& client = m_clients[i];
 
-    m_entityManager.takeSnapshot(&snapshot.entityManager);
+        if (!client.connectionCompleted) continue;
 
-    for (int i = 0; i < m_clients.firstInvalidIndex(); ++i) {
-        if (!m_clients[i].connectionCompleted) continue;
-        
-        CRCPacket outPacket;
-        outPacket << (u8) ClientCommand::Snapshot;
+        client.snapshotTimer += eTime;
+
+        if (client.snapshotTimer < client.snapshotRate) continue;
+
+        client.snapshotTimer -= client.snapshotRate;
+
+        //don't try to catch up if the server fell behind (send one snapshot and move on)
+        if (client.snapshotTimer >= client.snapshotRate) {
+            client.snapshotTimer = sf::Time::Zero;
+        }
+
+        if (!snapshot) {
+            //Take current snapshot (overwrites the oldest one)
+            snapshot = &m_snapshots.takeSnapshot(++m_lastSnapshotId, m_worldTime, m_entityManager);
+        }
+
+        if (m_pendingSnapshotCount == m_pendingSnapshots.size()) {
+            m_pendingSnapshots.emplace_back();
+        }
+
+        PendingSnapshot& pending = m_pendingSnapshots[m_pendingSnapshotCount++];
+        pending.clientIndex = i;
+
+        if (client.sentViews.size() != m_snapshots.getSize()) {
+            client.sentViews.assign(m_snapshots.getSize(), ClientView());
+        }
+
+        //the quadtree is not thread safe
+        addSnapshotItems(pending, client);
+    }
+
+    //the world doesn't change until all packets are encoded,
+    //so they can be packed in parallel (packEntity only reads from it)
+    m_workerPool.parallelFor(m_chunkCount, [this] (size_t i) {
+        EncodedChunk& chunk = m_chunks[i];
+
+        //clear keeps the capacity of the packet
+        chunk.data.clear();
+
+        const SnapshotHistory::Snapshot* prevSnapshot = m_snapshots.find(chunk.prevSnapshotId);
 
-        //@TODO: Should we use delta encoding to send all this data?
+        if (chunk.projectile) {
+            const ProjectileNetState* prevProj = (prevSnapshot ? prevSnapshot->getProjectile(chunk.uniqueId) : nullptr);
+            m_entityManager.packProjectile(chunk.uniqueId, prevProj, chunk.teamId, chunk.data);
 
-        outPacket << m_lastSnapshotId;
-        outPacket << m_clients[i].snapshotId;
-        outPacket << m_clients[i].latestInputId;
-        outPacket << m_clients[i].controlledEntityUniqueId;
-        outPacket << m_clients[i].forceFullUpdate;
+        } else {
+            const EntityNetState* prevState = (prevSnapshot ? prevSnapshot->getEntity(chunk.uniqueId) : nullptr);
+            m_entityManager.packEntity(chunk.uniqueId, prevState, chunk.teamId, chunk.data);
+        }
+    });
+
+    m_workerPool.parallelFor(m_pendingSnapshotCount, [this] (size_t i) {
+        PendingSnapshot& pending = m_pendingSnapshots[i];
+
+        packSnapshot(pending, m_clients[pending.clientIndex]);
+    });
+
+    //the socket is only used from the main thread
+    for (size_t i = 0; i < m_pendingSnapshotCount; ++i) {
+        PendingSnapshot& pending = m_pendingSnapshots[i];
+        ClientInfo& client = m_clients[pending.clientIndex];
+
+        sendPacket(pending.packet, client.connectionId, false);
+
+        //swapped to keep the capacity of both views
+        std::swap(client.sentViews[m_lastSnapshotId % client.sentViews.size()], pending.view);
+    }
+}
+
+void GameServer::addSnapshotItems(PendingSnapshot& pending, const ClientInfo& client)
+{
+    pending.teamId = (client.heroDead ? client.spectatingTeamId : client.teamId);
+    pending.baselineView = nullptr;
+    pending.entities.clear();
+    pending.projectiles.clear();
+    pending.removedEntities.clear();
+
+    if (!client.forceFullUpdate && client.snapshotId != 0) {
+        const ClientView& view = client.sentViews[client.snapshotId % client.sentViews.size()];
+
+        //we need to know what the client has in the baseline
+        if (view.snapshotId == client.snapshotId) {
+            pending.baselineView = &view;
+        }
+    }
+
+    const sf::FloatRect region = getInterestRegion(client);
+
+    //entities closer to the one the client is looking at have more priority
+    const Entity* viewedEntity = getViewedEntity(client);
+    const Vector2 viewCenter = (viewedEntity ? viewedEntity->getPosition() : Vector2(region.left + region.width/2.f, region.top + region.height/2.f));
+    const float viewRadius = std::max(region.width, region.height)/2.f;
 
-        EntityManager* snapshotManager = nullptr;
+    auto distancePriority = [&] (const Vector2& pos) -> float {
+        const float distance = Helper_vec2length(pos - viewCenter);
 
-        if (!m_clients[i].forceFullUpdate) {
-            if (m_clients[i].snapshotId < oldestSnapshotId) {
-                oldestSnapshotId = m_clients[i].snapshotId;
+        return 1.f - (1.f - MIN_DISTANCE_PRIORITY) * std::min(distance/viewRadius, 1.f);
+    };
+
+    m_entityManager.queryInterestEntities(region, pending.teamId, m_interestEntities);
+
+    //sorted to find the entities of the baseline that are no longer sent
+    std::sort(m_interestEntities.begin(), m_interestEntities.end());
+
+    for (u32 uniqueId : m_interestEntities) {
+        const Entity* entity = m_entityManager.entities.atUniqueId(uniqueId);
+
+        u32 prevSnapshotId = 0;
+        sf::Time timeSinceSent = NEW_ENTITY_PRIORITY_TIME;
+
+        const ReceivedEntity* received = (pending.baselineView ? ClientView_findEntity(*pending.baselineView, uniqueId) : nullptr);
+
+        if (received) {
+            const SnapshotHistory::Snapshot* prevSnapshot = m_snapshots.find(received->snapshotId);
+
+            //if the data the client has is too old it's no longer stored,
+            //so the entity has to be sent in full
+            if (prevSnapshot) {
+                prevSnapshotId = received->snapshotId;
+                timeSinceSent = m_worldTime - prevSnapshot->getWorldTime();
             }
+        }
+
+        SnapshotItem item;
+        item.uniqueId = uniqueId;
+        item.chunkIndex = addChunk(uniqueId, false, pending.teamId, prevSnapshotId);
 
-            auto it = m_snapshots.find(m_clients[i].snapshotId);
+        //the priority accumulates while the entity is not sent
+        item.required = (entity == viewedEntity);
+        item.priority = distancePriority(entity->getPosition()) * timeSinceSent.asSeconds();
+
+        pending.entities.push_back(item);
+    }
 
-            if (it != m_snapshots.end()) {
-                snapshotManager = &it->second.entityManager;
+    if (pending.baselineView) {
+        for (const ReceivedEntity& received : pending.baselineView->entities) {
+            if (!std::binary_search(m_interestEntities.begin(), m_interestEntities.end(), received.uniqueId)) {
+                pending.removedEntities.push_back(received.uniqueId);
             }
         }
+    }
+
+    //the client only reads this data if it has the entity (and entities of the interest region are always kept)
+    pending.sendControlledData = std::binary_search(m_interestEntities.begin(), m_interestEntities.end(), client.controlledEntityUniqueId);
+
+    //projectiles that are not sent are removed by the client
+    const SnapshotHistory::Snapshot* baseline = (pending.baselineView ? m_snapshots.find(pending.baselineView->snapshotId) : nullptr);
+
+    m_entityManager.queryInterestProjectiles(region, m_interestProjectiles);
+
+    for (u32 uniqueId : m_interestProjectiles) {
+        const Projectile* projectile = m_entityManager.projectiles.atUniqueId(uniqueId);
+
+        u32 prevSnapshotId = 0;
+
+        if (baseline && std::binary_search(pending.baselineView->projectiles.begin(), pending.baselineView->projectiles.end(), uniqueId)) {
+            prevSnapshotId = baseline->getId();
+        }
+
+        SnapshotItem item;
+        item.uniqueId = uniqueId;
+        item.chunkIndex = addChunk(uniqueId, true, pending.teamId, prevSnapshotId);
+
+        //they're not kept if they're not sent, so only the distance matters
+        item.priority = distancePriority(projectile->pos);
+
+        pending.projectiles.push_back(item);
+    }
+}
+
+void GameServer::packSnapshot(PendingSnapshot& pending, const ClientInfo& client)
+{
+    CRCPacket& outPacket = pending.packet;
+    outPacket.clear();
+
+    outPacket << (u8) ClientCommand::Snapshot;
+
+    //@TODO: Should we use delta encoding to send all this data?
+
+    outPacket << m_lastSnapshotId;
 
-        u8 teamId = (m_clients[i].heroDead ? m_clients[i].spectatingTeamId : m_clients[i].teamId);
+    //if the baseline is too old it's no longer stored,
+    //so the client has to receive the full snapshot
+    outPacket << (pending.baselineView ? pending.baselineView->snapshotId : 0);
 
-        m_entityManager.packData(snapshotManager, teamId, m_clients[i].controlledEntityUniqueId, outPacket);
+    outPacket << client.latestInputId;
+    outPacket << client.controlledEntityUniqueId;
+    outPacket << client.forceFullUpdate;
 
-        sendPacket(outPacket, m_clients[i].connectionId, false);
+    //the client keeps the rest of the entities of the baseline
+    outPacket << static_cast<u16>(pending.removedEntities.size());
+
+    for (u32 uniqueId : pending.removedEntities) {
+        outPacket.writeVarUint(uniqueId);
+    }
+
+    pending.controlledData.clear();
+
+    if (pending.sendControlledData) {
+        m_entityManager.packControlledData(client.controlledEntityUniqueId, pending.controlledData);
     }
 
-    //snapshots no longer needed are deleted
-    auto it = m_snapshots.begin();
-    while (it != m_snapshots.end()) {
-        if (it->first < oldestSnapshotId) {
-            it = m_snapshots.erase(it);
+    //the number of entities and projectiles is also sent
+    size_t packetSize = outPacket.getDataSize() + 2 * sizeof(u16) + pending.controlledData.getDataSize();
+
+    //items with the highest priority are sent first and the rest
+    //roll over to the next snapshot (the selected ones are moved to the front)
+    auto selectItems = [&] (std::vector<SnapshotItem>& items) {
+        std::sort(items.begin(), items.end(), SnapshotItem_compare);
+
+        size_t selected = 0;
+
+        for (size_t i = 0; i < items.size(); ++i) {
+            const size_t chunkSize = m_chunks[items[i].chunkIndex].data.getDataSize();
+
+            //smaller items might still fit
+            if (!items[i].required && packetSize + chunkSize > m_snapshotByteBudget) continue;
+
+            packetSize += chunkSize;
+            std::swap(items[selected++], items[i]);
+        }
+
+        items.resize(selected);
+    };
+
+    selectItems(pending.entities);
+    selectItems(pending.projectiles);
+
+    //each chunk starts at a new byte, so appending it
+    //produces the same bytes the client reads
+    outPacket << static_cast<u16>(pending.entities.size());
+
+    for (const SnapshotItem& item : pending.entities) {
+        const CRCPacket& data = m_chunks[item.chunkIndex].data;
+        outPacket.append(data.getData(), data.getDataSize());
+    }
+
+    outPacket << static_cast<u16>(pending.projectiles.size());
+
+    for (const SnapshotItem& item : pending.projectiles) {
+        const CRCPacket& data = m_chunks[item.chunkIndex].data;
+        outPacket.append(data.getData(), data.getDataSize());
+    }
+
+    outPacket.append(pending.controlledData.getData(), pending.controlledData.getDataSize());
+
+    //what the client has after receiving this snapshot
+    ClientView& view = pending.view;
+    view.snapshotId = m_lastSnapshotId;
+    view.entities.clear();
+    view.projectiles.clear();
+
+    if (pending.baselineView) {
+        for (const ReceivedEntity& received : pending.baselineView->entities) {
+            if (!std::binary_search(pending.removedEntities.begin(), pending.removedEntities.end(), received.uniqueId)) {
+                view.entities.push_back(received);
+            }
+        }
+    }
+
+    const size_t keptCount = view.entities.size();
+
+    for (const SnapshotItem& item : pending.entities) {
+        auto it = std::lower_bound(view.entities.begin(), view.entities.begin() + keptCount, item.uniqueId, ReceivedEntity_lessThan);
+
+        if (it != view.entities.begin() + keptCount && it->uniqueId == item.uniqueId) {
+            it->snapshotId = m_lastSnapshotId;
+
         } else {
-            it = std::next(it);
+            ReceivedEntity received;
+            received.uniqueId = item.uniqueId;
+            received.snapshotId = m_lastSnapshotId;
+
+            view.entities.push_back(received);
         }
     }
+
+    std::sort(view.entities.begin(), view.entities.end(), [] (const ReceivedEntity& lhs, const ReceivedEntity& rhs) {
+        return lhs.uniqueId < rhs.uniqueId;
+    });
+
+    for (const SnapshotItem& item : pending.projectiles) {
+        view.projectiles.push_back(item.uniqueId);
+    }
+
+    std::sort(view.projectiles.begin(), view.projectiles.end());
+}
+
+size_t GameServer::addChunk(u32 uniqueId, bool projectile, u8 teamId, u32 prevSnapshotId)
+{
+    const u32 prevSnapshotAge = (prevSnapshotId == 0 ? 0 : m_lastSnapshotId - prevSnapshotId + 1);
+    const u64 key = ChunkKey_make(uniqueId, projectile, teamId, prevSnapshotAge);
+
+    const u32* index = m_chunkIndices.find(key);
+
+    if (index) {
+        return *index;
+    }
+
+    if (m_chunkCount == m_chunks.size()) {
+        m_chunks.emplace_back();
+    }
+
+    EncodedChunk& chunk = m_chunks[m_chunkCount];
+    chunk.uniqueId = uniqueId;
+    chunk.projectile = projectile;
+    chunk.teamId = teamId;
+    chunk.prevSnapshotId = prevSnapshotId;
+
+    m_chunkIndices.insert(key, m_chunkCount);
+
+    return m_chunkCount++;
+}
+
+const Entity* GameServer::getViewedEntity(const ClientInfo& client) const
+{
+    return m_entityManager.entities.atUniqueId(client.heroDead ? client.spectatingUniqueId : client.controlledEntityUniqueId);
+}
+
+sf::FloatRect GameServer::getInterestRegion(const ClientInfo& client) const
+{
+    const Vector2 worldSize = static_cast<Vector2>(m_tileMap.getWorldSize());
+
+    //the whole world (with some margin for entities in the edges)
+    sf::FloatRect region(-m_interestMargin, -m_interestMargin, worldSize.x + 2.f * m_interestMargin, worldSize.y + 2.f * m_interestMargin);
+
+    if (!m_interestManagement) return region;
+
+    const Entity* entity = getViewedEntity(client);
+
+    if (!entity) return region;
+
+    //snapping to a grid smaller than the margin still covers the whole view
+    Vector2 center = entity->getPosition();
+
+    if (m_interestMargin > 0.f) {
+        center.x = std::round(center.x/m_interestMargin) * m_interestMargin;
+        center.y = std::round(center.y/m_interestMargin) * m_interestMargin;
+    }
+
+    const Vector2 halfSize = m_interestViewSize/2.f + Vector2(m_interestMargin, m_interestMargin);
+
+    return sf::FloatRect(center - halfSize, 2.f * halfSize);
 }
 
 void GameServer::processPacket(HSteamNetConnection connectionId, CRCPacket& packet)
@@ -464,12 +909,13 @@ void GameServer::handleCommand(u8 command, int index, CRCPacket& packet)
 
             //only apply inputs that haven't been applied yet
             if (entity && playerInput.id > m_clients[index].latestInputId) {
-                //@WIP: Don't hardcode 150, use the same interpolation delay the client is using
-                //Client::snapshotsRequiredToRender / Server::m_snapshotRate  = 0.150 seconds = renderDelay
+                //the client renders other entities this far in the past
+                //renderDelay = requiredSnapshotsToRender * snapshotRate
                 //clientDelay = pingDelay + renderDelay
-                int clientDelay = Helper_clamp(m_clients[index].ping, 0, m_maxPingCorrection.asMilliseconds()) + 150;
+                sf::Time renderDelay = m_clients[index].snapshotRate * static_cast<sf::Int64>(m_clients[index].requiredSnapshotsToRender);
+                int clientDelay = Helper_clamp(m_clients[index].ping, 0, m_maxPingCorrection.asMilliseconds()) + renderDelay.asMilliseconds();
 
-                entity->applyInput(playerInput, ManagersContext(&m_entityManager, &m_collisionManager, &m_tileMap, m_gameMode.get()), clientDelay);
+                entity->applyInput(playerInput, ManagersContext(&m_entityManager, &m_collisionManager, &m_tileMap, m_gameMode.get(), &m_lagCompensation), clientDelay);
 
                 m_clients[index].latestInputId = playerInput.id;
             }
@@ -491,13 +937,23 @@ void GameServer::handleCommand(u8 command, int index, CRCPacket& packet)
 
         case ServerCommand::ChangeSnapshotRate:
         {
-            //@TODO: Make this command actually do something
             u64 snapshotRate_u64;
             packet >> snapshotRate_u64;
 
-            sf::Time snapshotRate = sf::microseconds(snapshotRate_u64);
+            //we still have to load the data even if clients can't change it
+            if (!m_canClientsChangeSnapshotRate) break;
 
-            m_clients[index].snapshotRate = Helper_clamp(snapshotRate, m_maxSnapshotRate, m_minSnapshotRate);
+            setClientSnapshotRate(index, sf::microseconds(snapshotRate_u64));
+
+            break;
+        }
+
+        case ServerCommand::ChangeRequiredSnapshotsToRender:
+        {
+            u8 requiredSnapshots;
+            packet >> requiredSnapshots;
+
+            m_clients[index].requiredSnapshotsToRender = Helper_clamp(requiredSnapshots, (u8) 1, MAX_REQUIRED_SNAPSHOTS_TO_RENDER);
 
             break;
         }
@@ -557,8 +1013,9 @@ void GameServer::onConnectionCompleted(HSteamNetConnection connectionId)
     int index = getIndexByConnectionId(connectionId);
 
     if (index != -1) {
-        m_clients[index].snapshotRate = m_snapshotRate;
+        setClientSnapshotRate(index, m_snapshotRate);
         m_clients[index].inputRate = m_defaultInputRate;
+        m_clients[index].requiredSnapshotsToRender = DEFAULT_REQUIRED_SNAPSHOTS_TO_RENDER;
 
         CRCPacket outPacket;
         outPacket << (u8) ClientCommand::RequestInitialInfo; 
@@ -721,6 +1178,23 @@ bool GameServer::canNewClientConnect() const
     return (!m_gameStarted || m_gameMode->canJoinMidMatch()) && m_clients.firstInvalidIndex() < m_gameMode->getMaxPlayers();
 }
 
+void GameServer::setClientSnapshotRate(int index, const sf::Time& snapshotRate)
+{
+    ClientInfo& client = m_clients[index];
+
+    client.snapshotRate = Helper_clamp(snapshotRate, m_maxSnapshotRate, m_minSnapshotRate);
+
+    //spread clients across the updates of a snapshot period
+    //so we don't encode snapshots for everyone in the same update
+    int updatesPerSnapshot = static_cast<int>(std::ceil(client.snapshotRate/m_updateRate));
+
+    if (updatesPerSnapshot > 1) {
+        client.snapshotTimer = m_updateRate * static_cast<sf::Int64>(client.uniqueId % updatesPerSnapshot);
+    } else {
+        client.snapshotTimer = sf::Time::Zero;
+    }
+}
+
 bool GameServer::addClientToPoll(int index)
 {
     if (!m_clients.isIndexValid(index)) {
@@ -798,12 +1272,79 @@ void GameServer::loadFromJson(const rapidjson::Document& doc)
         m_minSnapshotRate = sf::seconds(1.f/10.f);
     }
 
+    //number of snapshots kept to be used as baseline for delta encoding
+    if (doc.HasMember("snapshot_history_size")) {
+        m_snapshots.resize(doc["snapshot_history_size"].GetUint());
+    } else {
+        m_snapshots.resize(64);
+    }
+
+    if (doc.HasMember("interest_management")) {
+        m_interestManagement = doc["interest_management"].GetBool();
+    } else {
+        m_interestManagement = true;
+    }
+
+    //world units visible in the client (with the default zoom)
+    if (doc.HasMember("interest_view_width")) {
+        m_interestViewSize.x = doc["interest_view_width"].GetFloat();
+    } else {
+        m_interestViewSize.x = 1400.f;
+    }
+
+    if (doc.HasMember("interest_view_height")) {
+        m_interestViewSize.y = doc["interest_view_height"].GetFloat();
+    } else {
+        m_interestViewSize.y = 800.f;
+    }
+
+    if (doc.HasMember("interest_margin")) {
+        m_interestMargin = doc["interest_margin"].GetFloat();
+    } else {
+        m_interestMargin = 300.f;
+    }
+
+    //snapshots are kept under the MTU (entities that don't fit are sent later)
+    if (doc.HasMember("snapshot_byte_budget")) {
+        m_snapshotByteBudget = doc["snapshot_byte_budget"].GetUint();
+    } else {
+        m_snapshotByteBudget = 1200;
+    }
+
+    //maximum time the server sleeps without receiving messages
+    //(0 only receives messages before each update)
+    if (doc.HasMember("receive_poll_interval")) {
+        m_tickScheduler.setPollInterval(sf::milliseconds(doc["receive_poll_interval"].GetUint()));
+    } else {
+        m_tickScheduler.setPollInterval(sf::milliseconds(1));
+    }
+
+    m_collisionManager.loadFromJson(doc);
+
+    //0 encodes the snapshots in the main thread
+    if (doc.HasMember("snapshot_encoding_threads")) {
+        m_workerPool.resize(doc["snapshot_encoding_threads"].GetUint());
+    } else {
+        m_workerPool.resize(0);
+    }
+
+    //in seconds
+    if (doc.HasMember("memory_log_interval")) {
+        m_memoryLogInterval = sf::seconds(doc["memory_log_interval"].GetFloat());
+    } else {
+        m_memoryLogInterval = sf::seconds(300.f);
+    }
+
     if (doc.HasMember("max_ping_correction")) {
         m_maxPingCorrection = sf::milliseconds(doc["max_ping_correction"].GetUint());
     } else {
         m_maxPingCorrection = sf::milliseconds(70);
     }
 
+    //enough updates to rewind entities for the most delayed client
+    const sf::Time maxRenderDelay = std::max(m_minSnapshotRate, m_maxSnapshotRate) * static_cast<sf::Int64>(MAX_REQUIRED_SNAPSHOTS_TO_RENDER);
+    m_lagCompensation.resize(static_cast<size_t>(std::ceil((m_maxPingCorrection + maxRenderDelay)/m_updateRate)) + 2);
+
     if (doc.HasMember("game_end_lingering_time")) {
         m_gameEndLingeringTime = sf::seconds(doc["game_end_lingering_time"].GetFloat());
     } else {
@@ -1,6 +1,7 @@
 #include "hero.hpp"
 
-#include "bit_stream.hpp"
+#include <cstring>
+
 #include "game_mode.hpp"
 #include "client_entity_manager.hpp"
 #include "entities/food.hpp"
@@ -39,7 +40,7 @@ void HeroBase::loadFromJson(const rapidjson::Document& doc)
 
 Hero* Hero::clone() const
 {
-    return new Hero(*this);
+    return new (m_type) Hero(*this);
 }
 
 void Hero::loadFromJson(const rapidjson::Document& doc)
@@ -51,16 +52,16 @@ void Hero::loadFromJson(const rapidjson::Document& doc)
     m_powerDamageMultiplier = doc["damage_multiplier_per_level"].GetFloat()/1000.f;
 }
 
-void Hero::packData(const Entity* prevEntity, u8 teamId, u32 controlledEntityUniqueId, CRCPacket& outPacket) const
+void Hero::packData(const EntityNetState* prevState, u8 teamId, const Vector2u& worldSize, CRCPacket& outPacket) const
 {
-    Unit::packData(prevEntity, teamId, controlledEntityUniqueId, outPacket);
+    Unit::packData(prevState, teamId, worldSize, outPacket);
 
-    const Hero* prevHero = static_cast<const Hero*>(prevEntity);
+    const HeroNetState* prevHero = static_cast<const HeroNetState*>(prevState);
 
-    bool displayNameChanged = !prevHero || prevHero->getDisplayName() != m_displayName;
+    bool displayNameChanged = !prevHero || m_displayName.compare(prevHero->displayName) != 0;
     outPacket << displayNameChanged;
 
-    bool powerLevelChanged = !prevHero || prevHero->getPowerLevel() != getPowerLevel();
+    bool powerLevelChanged = !prevHero || prevHero->powerLevel != getPowerLevel();
     outPacket << powerLevelChanged;
 
     if (displayNameChanged) {
@@ -72,6 +73,19 @@ void Hero::packData(const Entity* prevEntity, u8 teamId, u32 controlledEntityUni
     }
 }
 
+void Hero::takeNetState(EntityNetState& state) const
+{
+    Unit::takeNetState(state);
+
+    HeroNetState& heroState = static_cast<HeroNetState&>(state);
+    heroState.powerLevel = getPowerLevel();
+
+    //display names are never longer than maxDisplayNameSize
+    //(strncpy fills the rest with zeros, so states can be compared as raw memory)
+    std::strncpy(heroState.displayName, m_displayName.c_str(), NET_STATE_DISPLAY_NAME_SIZE - 1);
+    heroState.displayName[NET_STATE_DISPLAY_NAME_SIZE - 1] = '\0';
+}
+
 void Hero::onDeath(bool& dead, const ManagersContext& context)
 {
     Unit::onDeath(dead, context);
@@ -108,7 +122,7 @@ void Hero::consumeFood(u8 foodType)
 
 C_Hero* C_Hero::clone() const
 {
-    return new C_Hero(*this);
+    return new (m_type) C_Hero(*this);
 }
 
 void C_Hero::loadFromJson(const rapidjson::Document& doc, u16 textureId, const Context& context)
@@ -117,9 +131,9 @@ void C_Hero::loadFromJson(const rapidjson::Document& doc, u16 textureId, const C
     HeroBase::loadFromJson(doc);
 }
 
-void C_Hero::loadFromData(u32 controlledEntityUniqueId, CRCPacket& inPacket, CasterSnapshot& casterSnapshot)
+void C_Hero::loadFromData(const Vector2u& worldSize, CRCPacket& inPacket, CasterSnapshot& casterSnapshot)
 {
-    C_Unit::loadFromData(controlledEntityUniqueId, inPacket, casterSnapshot);
+    C_Unit::loadFromData(worldSize, inPacket, casterSnapshot);
 
     bool displayNameChanged;
     bool powerLevelChanged;
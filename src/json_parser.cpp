@@ -3,8 +3,15 @@
 #include <iostream>
 #include <experimental/filesystem>
 
+#include "memory_stats.hpp"
+
 namespace filesys = std::experimental::filesystem;
 
+JsonParser::~JsonParser()
+{
+    MemoryStats_deallocate(MEMORY_TAG_JSON, m_trackedBytes);
+}
+
 void JsonParser::loadAll(const std::string &dir)
 {
     for (auto it = filesys::recursive_directory_iterator(dir); it != filesys::recursive_directory_iterator(); ++it) {
@@ -44,6 +51,8 @@ void JsonParser::loadDocument(const std::string &filename, const std::string& id
 
     if (!inserted.second) {
         std::cerr << "Error - Json document " << filename << " not loaded properly" << std::endl;
+    } else {
+        trackDocument(*inserted.first->second);
     }
 }
 
@@ -57,6 +66,8 @@ void JsonParser::loadString(const std::string &str, const std::string &id)
 
     if (!inserted.second) {
         std::cerr << "Error - Json string not loaded properly" << std::endl;
+    } else {
+        trackDocument(*inserted.first->second);
     }
 }
 
@@ -88,3 +99,12 @@ bool JsonParser::isLoaded(const std::string& id) const
 {
     return (m_documents.find(id) != m_documents.end());
 }
+
+void JsonParser::trackDocument(rapidjson::Document& document)
+{
+    //documents are never modified after they're parsed
+    const size_t bytes = sizeof(rapidjson::Document) + document.GetAllocator().Capacity();
+
+    MemoryStats_allocate(MEMORY_TAG_JSON, bytes);
+    m_trackedBytes += bytes;
+}
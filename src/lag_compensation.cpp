@@ -0,0 +1,118 @@
+#include "lag_compensation.hpp"
+
+#include <algorithm>
+
+#include "collision_manager.hpp"
+
+LagCompensation::LagCompensation(size_t size)
+{
+    resize(size);
+}
+
+void LagCompensation::resize(size_t size)
+{
+    m_frames.clear();
+    m_frames.resize(std::max(size, (size_t) 1));
+
+    clear();
+}
+
+void LagCompensation::clear()
+{
+    m_first = 0;
+    m_count = 0;
+}
+
+void LagCompensation::record(sf::Time worldTime, const CollisionManager& collisionManager)
+{
+    //the oldest update is overwritten when the buffer is full
+    if (m_count == m_frames.size()) {
+        m_first = (m_first + 1) % m_frames.size();
+        m_count--;
+    }
+
+    Frame& frame = m_frames[(m_first + m_count) % m_frames.size()];
+    m_count++;
+
+    frame.worldTime = worldTime;
+    frame.records.clear();
+
+    for (const BroadphaseProxy* proxy : collisionManager.getProxies()) {
+        Record record;
+        record.uniqueId = proxy->uniqueId;
+        record.pos = proxy->body.circle.center;
+        record.radius = static_cast<u8>(proxy->body.circle.radius);
+        record.teamId = proxy->teamId;
+
+        frame.records.push_back(record);
+    }
+
+    std::sort(frame.records.begin(), frame.records.end(), [] (const Record& lhs, const Record& rhs) {
+        return lhs.uniqueId < rhs.uniqueId;
+    });
+}
+
+sf::Time LagCompensation::getOldestTime() const
+{
+    return m_count == 0 ? sf::Time::Zero : _getFrame(0).worldTime;
+}
+
+sf::Time LagCompensation::getLatestTime() const
+{
+    return m_count == 0 ? sf::Time::Zero : _getFrame(m_count - 1).worldTime;
+}
+
+size_t LagCompensation::getCount() const
+{
+    return m_count;
+}
+
+const LagCompensation::Frame& LagCompensation::_getFrame(size_t i) const
+{
+    return m_frames[(m_first + i) % m_frames.size()];
+}
+
+void LagCompensation::_findFrames(sf::Time worldTime, const Frame*& older, const Frame*& newer, float& alpha) const
+{
+    newer = nullptr;
+    alpha = 0.f;
+
+    if (worldTime <= getOldestTime()) {
+        older = &_getFrame(0);
+        return;
+    }
+
+    //updates are searched from the latest since most queries are close to the present
+    for (size_t i = m_count - 1; i > 0; --i) {
+        const Frame& frame = _getFrame(i - 1);
+
+        if (frame.worldTime <= worldTime) {
+            older = &frame;
+            newer = &_getFrame(i);
+
+            if (worldTime >= newer->worldTime) {
+                older = newer;
+                newer = nullptr;
+            } else {
+                alpha = (worldTime - older->worldTime)/(newer->worldTime - older->worldTime);
+            }
+
+            return;
+        }
+    }
+
+    older = &_getFrame(0);
+}
+
+const LagCompensation::Record* LagCompensation::_findRecord(const Frame& frame, u32 uniqueId)
+{
+    auto it = std::lower_bound(frame.records.begin(), frame.records.end(), uniqueId, [] (const Record& record, u32 uniqueId) {
+        return record.uniqueId < uniqueId;
+    });
+
+    if (it != frame.records.end() && it->uniqueId == uniqueId) {
+        return &(*it);
+    }
+
+    return nullptr;
+}
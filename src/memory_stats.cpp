@@ -0,0 +1,98 @@
+#include "memory_stats.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+
+namespace {
+
+struct AtomicMemoryStats {
+    std::atomic<size_t> current{0};
+    std::atomic<size_t> peak{0};
+};
+
+AtomicMemoryStats TAG_STATS[MEMORY_TAG_MAX];
+
+const char* MEMORY_TAG_NAMES[MEMORY_TAG_MAX] = {
+    "snapshot_history",
+    "client_snapshots",
+    "quadtree",
+    "uniform_grid",
+    "lag_compensation",
+    "buckets",
+    "entity_pools",
+    "json"
+};
+
+std::string MemoryStats_formatBytes(size_t bytes)
+{
+    std::ostringstream stream;
+    stream << std::fixed << std::setprecision(1);
+
+    if (bytes >= 1024 * 1024) {
+        stream << static_cast<double>(bytes)/(1024.0 * 1024.0) << " MB";
+    } else {
+        stream << static_cast<double>(bytes)/1024.0 << " KB";
+    }
+
+    return stream.str();
+}
+
+}
+
+void MemoryStats_allocate(MemoryTag tag, size_t bytes)
+{
+    AtomicMemoryStats& stats = TAG_STATS[tag];
+
+    const size_t current = stats.current.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    size_t peak = stats.peak.load(std::memory_order_relaxed);
+
+    //another thread might be raising the peak at the same time
+    while (current > peak && !stats.peak.compare_exchange_weak(peak, current, std::memory_order_relaxed));
+}
+
+void MemoryStats_deallocate(MemoryTag tag, size_t bytes)
+{
+    TAG_STATS[tag].current.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+MemoryStats MemoryStats_get(MemoryTag tag)
+{
+    MemoryStats stats;
+    stats.current = TAG_STATS[tag].current.load(std::memory_order_relaxed);
+    stats.peak = TAG_STATS[tag].peak.load(std::memory_order_relaxed);
+
+    return stats;
+}
+
+const char* MemoryStats_tagName(MemoryTag tag)
+{
+    return MEMORY_TAG_NAMES[tag];
+}
+
+void MemoryStats_print()
+{
+    std::cout << "Memory (current/peak):" << std::endl;
+
+    for (int i = 0; i < MEMORY_TAG_MAX; ++i) {
+        const MemoryStats stats = MemoryStats_get(static_cast<MemoryTag>(i));
+
+        std::cout << "    " << MEMORY_TAG_NAMES[i] << ": " << MemoryStats_formatBytes(stats.current)
+                  << "/" << MemoryStats_formatBytes(stats.peak) << std::endl;
+    }
+}
+
+std::string MemoryStats_summary()
+{
+    std::string summary;
+
+    for (int i = 0; i < MEMORY_TAG_MAX; ++i) {
+        const MemoryStats stats = MemoryStats_get(static_cast<MemoryTag>(i));
+
+        if (i != 0) summary += ", ";
+        summary += std::string(MEMORY_TAG_NAMES[i]) + ": " + MemoryStats_formatBytes(stats.current);
+        summary += " (peak " + MemoryStats_formatBytes(stats.peak) + ")";
+    }
+
+    return summary;
+}
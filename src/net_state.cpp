@@ -0,0 +1,8 @@
+#include "net_state.hpp"
+
+#include "bounding_body.hpp"
+
+bool NetState_isInInterest(const sf::FloatRect& region, const Vector2& pos, u8 collisionRadius)
+{
+    return Circlef(pos, static_cast<float>(collisionRadius)).intersects(region);
+}
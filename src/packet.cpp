@@ -2,6 +2,7 @@
 
 #include <cstring>
 #include <cwchar>
+#include <algorithm>
 
 //ntohs function (converts bytes from TCP/IP network order to host order)
 #ifdef _WIN32
@@ -15,8 +16,8 @@ Packet::Packet() :
 m_readPos(0),
 m_sendPos(0),
 m_isValid(true),
-m_boolReadPos(0),
-m_boolSendPos(0)
+m_bitReadPos(0),
+m_bitSendPos(0)
 {
 
 }
@@ -34,7 +35,7 @@ void Packet::append(const void* data, std::size_t sizeInBytes)
         m_data.resize(start + sizeInBytes);
         std::memcpy(&m_data[start], data, sizeInBytes);
         
-        m_boolSendPos = 0;
+        m_bitSendPos = 0;
     }
 }
 
@@ -44,8 +45,8 @@ void Packet::clear()
     m_readPos = 0;
     m_isValid = true;
 
-    m_boolReadPos = 0;
-    m_boolSendPos = 0;
+    m_bitReadPos = 0;
+    m_bitSendPos = 0;
 }
 
 const void* Packet::getData() const
@@ -63,6 +64,108 @@ bool Packet::endOfPacket() const
     return m_readPos >= m_data.size();
 }
 
+void Packet::writeBits(sf::Uint32 value, std::size_t bitCount)
+{
+    while (bitCount > 0)
+    {
+        if (m_bitSendPos == 0)
+        {
+            m_data.push_back('\0');
+        }
+
+        // Fill as many bits as possible of the current byte
+        std::size_t count = std::min(8 - m_bitSendPos, bitCount);
+        sf::Uint32 mask = (1u << count) - 1;
+
+        sf::Uint8 byte = *reinterpret_cast<const sf::Uint8*>(&m_data.back());
+        byte |= static_cast<sf::Uint8>((value & mask) << m_bitSendPos);
+
+        m_data.back() = *reinterpret_cast<char*>(&byte);
+
+        value >>= count;
+        bitCount -= count;
+        m_bitSendPos = (m_bitSendPos + count) % 8;
+    }
+}
+
+void Packet::readBits(sf::Uint32& value, std::size_t bitCount)
+{
+    value = 0;
+    std::size_t shift = 0;
+
+    while (bitCount > 0)
+    {
+        if (m_bitReadPos == 0)
+        {
+            if (!checkSize(1)) return;
+
+            m_readPos += 1;
+        }
+
+        std::size_t count = std::min(8 - m_bitReadPos, bitCount);
+        sf::Uint32 mask = (1u << count) - 1;
+
+        sf::Uint8 byte = *reinterpret_cast<const sf::Uint8*>(&m_data[m_readPos - 1]);
+        value |= ((static_cast<sf::Uint32>(byte) >> m_bitReadPos) & mask) << shift;
+
+        shift += count;
+        bitCount -= count;
+        m_bitReadPos = (m_bitReadPos + count) % 8;
+    }
+}
+
+void Packet::writeVarUint(sf::Uint32 value)
+{
+    while (value >= 0x80)
+    {
+        writeBits((value & 0x7f) | 0x80, 8);
+        value >>= 7;
+    }
+
+    writeBits(value, 8);
+}
+
+void Packet::readVarUint(sf::Uint32& value)
+{
+    value = 0;
+
+    // 5 groups are enough for 32 bits
+    for (std::size_t shift = 0; shift < 35; shift += 7)
+    {
+        sf::Uint32 group;
+        readBits(group, 8);
+
+        if (!m_isValid) return;
+
+        value |= (group & 0x7f) << shift;
+
+        if ((group & 0x80) == 0) return;
+    }
+
+    // Too many groups, the data is corrupted
+    m_isValid = false;
+}
+
+void Packet::writeVarInt(sf::Int32 value)
+{
+    sf::Uint32 zigzag = (static_cast<sf::Uint32>(value) << 1) ^ static_cast<sf::Uint32>(value >> 31);
+    writeVarUint(zigzag);
+}
+
+void Packet::readVarInt(sf::Int32& value)
+{
+    sf::Uint32 zigzag;
+    readVarUint(zigzag);
+
+    value = static_cast<sf::Int32>((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+}
+
+void Packet::alignRead()
+{
+    // The current byte was already consumed when its first bit was read
+    m_bitReadPos = 0;
+}
+
 Packet::operator BoolType() const
 {
     return m_isValid ? &Packet::checkSize : NULL;
@@ -70,7 +173,7 @@ Packet::operator BoolType() const
 
 Packet& Packet::operator >>(bool& data)
 {
-    if (m_boolReadPos == 0)
+    if (m_bitReadPos == 0)
     {
         //only check data size for the first bit
         if (!checkSize(sizeof(data))) return *this;
@@ -80,9 +183,9 @@ Packet& Packet::operator >>(bool& data)
 
     sf::Uint8 byte = *reinterpret_cast<const sf::Uint8*>(&m_data[m_readPos - 1]);
 
-    data = (1 << m_boolReadPos) & byte;
+    data = (1 << m_bitReadPos) & byte;
 
-    m_boolReadPos = (m_boolReadPos + 1) % 8;
+    m_bitReadPos = (m_bitReadPos + 1) % 8;
 
     return *this;
 }
@@ -93,7 +196,7 @@ Packet& Packet::operator >>(sf::Int8& data)
     {
         data = *reinterpret_cast<const sf::Int8*>(&m_data[m_readPos]);
         m_readPos += sizeof(data);
-        m_boolReadPos = 0;
+        m_bitReadPos = 0;
     }
 
     return *this;
@@ -105,7 +208,7 @@ Packet& Packet::operator >>(sf::Uint8& data)
     {
         data = *reinterpret_cast<const sf::Uint8*>(&m_data[m_readPos]);
         m_readPos += sizeof(data);
-        m_boolReadPos = 0;
+        m_bitReadPos = 0;
     }
 
     return *this;
@@ -117,7 +220,7 @@ Packet& Packet::operator >>(sf::Int16& data)
     {
         data = ntohs(*reinterpret_cast<const sf::Int16*>(&m_data[m_readPos]));
         m_readPos += sizeof(data);
-        m_boolReadPos = 0;
+        m_bitReadPos = 0;
     }
 
     return *this;
@@ -129,7 +232,7 @@ Packet& Packet::operator >>(sf::Uint16& data)
     {
         data = ntohs(*reinterpret_cast<const sf::Uint16*>(&m_data[m_readPos]));
         m_readPos += sizeof(data);
-        m_boolReadPos = 0;
+        m_bitReadPos = 0;
     }
 
     return *this;
@@ -141,7 +244,7 @@ Packet& Packet::operator >>(sf::Int32& data)
     {
         data = ntohl(*reinterpret_cast<const sf::Int32*>(&m_data[m_readPos]));
         m_readPos += sizeof(data);
-        m_boolReadPos = 0;
+        m_bitReadPos = 0;
     }
 
     return *this;
@@ -153,7 +256,7 @@ Packet& Packet::operator >>(sf::Uint32& data)
     {
         data = ntohl(*reinterpret_cast<const sf::Uint32*>(&m_data[m_readPos]));
         m_readPos += sizeof(data);
-        m_boolReadPos = 0;
+        m_bitReadPos = 0;
     }
 
     return *this;
@@ -175,7 +278,7 @@ Packet& Packet::operator >>(sf::Int64& data)
                (static_cast<sf::Int64>(bytes[6]) <<  8) |
                (static_cast<sf::Int64>(bytes[7])      );
         m_readPos += sizeof(data);
-        m_boolReadPos = 0;
+        m_bitReadPos = 0;
     }
 
     return *this;
@@ -197,7 +300,7 @@ Packet& Packet::operator >>(sf::Uint64& data)
                (static_cast<sf::Uint64>(bytes[6]) <<  8) |
                (static_cast<sf::Uint64>(bytes[7])      );
         m_readPos += sizeof(data);
-        m_boolReadPos = 0;
+        m_bitReadPos = 0;
     }
 
     return *this;
@@ -209,7 +312,7 @@ Packet& Packet::operator >>(float& data)
     {
         data = *reinterpret_cast<const float*>(&m_data[m_readPos]);
         m_readPos += sizeof(data);
-        m_boolReadPos = 0;
+        m_bitReadPos = 0;
     }
 
     return *this;
@@ -221,7 +324,7 @@ Packet& Packet::operator >>(double& data)
     {
         data = *reinterpret_cast<const double*>(&m_data[m_readPos]);
         m_readPos += sizeof(data);
-        m_boolReadPos = 0;
+        m_bitReadPos = 0;
     }
 
     return *this;
@@ -241,7 +344,7 @@ Packet& Packet::operator >>(char* data)
 
         // Update reading position
         m_readPos += length;
-        m_boolReadPos = 0;
+        m_bitReadPos = 0;
     }
 
     return *this;
@@ -261,7 +364,7 @@ Packet& Packet::operator >>(std::string& data)
 
         // Update reading position
         m_readPos += length;
-        m_boolReadPos = 0;
+        m_bitReadPos = 0;
     }
 
     return *this;
@@ -283,7 +386,7 @@ Packet& Packet::operator >>(wchar_t* data)
             data[i] = static_cast<wchar_t>(character);
         }
         data[length] = L'\0';
-        m_boolReadPos = 0;
+        m_bitReadPos = 0;
     }
 
     return *this;
@@ -305,7 +408,7 @@ Packet& Packet::operator >>(std::wstring& data)
             *this >> character;
             data += static_cast<wchar_t>(character);
         }
-        m_boolReadPos = 0;
+        m_bitReadPos = 0;
     }
 
     return *this;
@@ -327,7 +430,7 @@ Packet& Packet::operator >>(sf::String& data)
             *this >> character;
             data += character;
         }
-        m_boolReadPos = 0;
+        m_bitReadPos = 0;
     }
 
     return *this;
@@ -335,7 +438,7 @@ Packet& Packet::operator >>(sf::String& data)
 
 Packet& Packet::operator <<(bool data)
 {
-    if (m_boolSendPos == 0) 
+    if (m_bitSendPos == 0) 
     {
         m_data.resize(m_data.size() + 1, '\0');
     }
@@ -343,12 +446,12 @@ Packet& Packet::operator <<(bool data)
     if (data)
     {
         sf::Uint8 byte = *reinterpret_cast<const sf::Uint8*>(&m_data.back());
-        byte |= (1 << m_boolSendPos);
+        byte |= (1 << m_bitSendPos);
 
         m_data.back() = *reinterpret_cast<char*>(&byte);
     }
 
-    m_boolSendPos = (m_boolSendPos + 1) % 8;
+    m_bitSendPos = (m_bitSendPos + 1) % 8;
 
     return *this;
 }
@@ -478,7 +581,7 @@ Packet& Packet::operator <<(const wchar_t* data)
     for (const wchar_t* c = data; *c != L'\0'; ++c)
         *this << static_cast<sf::Uint32>(*c);
     
-    m_boolSendPos = 0;
+    m_bitSendPos = 0;
 
     return *this;
 }
@@ -495,7 +598,7 @@ Packet& Packet::operator <<(const std::wstring& data)
         for (std::wstring::const_iterator c = data.begin(); c != data.end(); ++c)
             *this << static_cast<sf::Uint32>(*c);
         
-        m_boolSendPos = 0;
+        m_bitSendPos = 0;
     }
 
     return *this;
@@ -513,7 +616,7 @@ Packet& Packet::operator <<(const sf::String& data)
         for (sf::String::ConstIterator c = data.begin(); c != data.end(); ++c)
             *this << *c;
         
-        m_boolSendPos = 0;
+        m_bitSendPos = 0;
     }
 
     return *this;
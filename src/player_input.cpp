@@ -2,7 +2,6 @@
 
 #include <sstream>
 
-#include "bit_stream.hpp"
 #include "helper.hpp"
 #include "defines.hpp"
 #include "buff.hpp"
@@ -0,0 +1,190 @@
+#include "projectile_batch.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+#include "collision_manager.hpp"
+
+#ifdef __SSE2__
+    #include <emmintrin.h>
+#endif
+
+void ProjectileBatch_gather(ProjectileBatch& batch, const Bucket<Projectile>& projectiles)
+{
+    batch.count = projectiles.firstInvalidIndex();
+
+    const size_t paddedCount = (batch.count + PROJECTILE_BATCH_WIDTH - 1)/PROJECTILE_BATCH_WIDTH * PROJECTILE_BATCH_WIDTH;
+
+    //the padding is zeroed so it never expires and doesn't move
+    batch.posX.assign(paddedCount, 0.f);
+    batch.posY.assign(paddedCount, 0.f);
+    batch.velX.assign(paddedCount, 0.f);
+    batch.velY.assign(paddedCount, 0.f);
+    batch.speed.assign(paddedCount, 0.f);
+    batch.distanceTraveled.assign(paddedCount, 0.f);
+    batch.range.assign(paddedCount, 0.f);
+    batch.expired.assign(paddedCount, 0);
+    batch.startPos.resize(batch.count);
+
+    for (size_t i = 0; i < batch.count; ++i) {
+        const Projectile& projectile = projectiles[i];
+
+        batch.posX[i] = projectile.pos.x;
+        batch.posY[i] = projectile.pos.y;
+        batch.velX[i] = projectile.vel.x;
+        batch.velY[i] = projectile.vel.y;
+
+        //the velocity always has the length of the movement speed
+        //(no need to compute the length of each movement)
+        batch.speed[i] = projectile.movementSpeed;
+
+        batch.distanceTraveled[i] = projectile.distanceTraveled;
+        batch.range[i] = projectile.range;
+
+        batch.expired[i] = projectile.dead;
+
+        batch.startPos[i] = projectile.pos;
+    }
+}
+
+void ProjectileBatch_integrate(ProjectileBatch& batch, float eTime)
+{
+    size_t i = 0;
+
+#ifdef __SSE2__
+    const __m128 dt = _mm_set1_ps(eTime);
+    const __m128 zero = _mm_setzero_ps();
+
+    for (; i + PROJECTILE_BATCH_WIDTH <= batch.posX.size(); i += PROJECTILE_BATCH_WIDTH) {
+        const __m128 range = _mm_loadu_ps(&batch.range[i]);
+        __m128 distance = _mm_loadu_ps(&batch.distanceTraveled[i]);
+
+        //range != 0 && distance > range
+        const __m128 expired = _mm_and_ps(_mm_cmpneq_ps(range, zero), _mm_cmpgt_ps(distance, range));
+
+        //expired projectiles don't move
+        const __m128 moveTime = _mm_andnot_ps(expired, dt);
+
+        __m128 posX = _mm_loadu_ps(&batch.posX[i]);
+        __m128 posY = _mm_loadu_ps(&batch.posY[i]);
+
+        posX = _mm_add_ps(posX, _mm_mul_ps(_mm_loadu_ps(&batch.velX[i]), moveTime));
+        posY = _mm_add_ps(posY, _mm_mul_ps(_mm_loadu_ps(&batch.velY[i]), moveTime));
+        distance = _mm_add_ps(distance, _mm_mul_ps(_mm_loadu_ps(&batch.speed[i]), moveTime));
+
+        _mm_storeu_ps(&batch.posX[i], posX);
+        _mm_storeu_ps(&batch.posY[i], posY);
+        _mm_storeu_ps(&batch.distanceTraveled[i], distance);
+
+        const int mask = _mm_movemask_ps(expired);
+
+        for (size_t j = 0; j < PROJECTILE_BATCH_WIDTH; ++j) {
+            batch.expired[i + j] |= (mask >> j) & 1;
+        }
+    }
+#endif
+
+    //scalar version (used if SIMD is not available)
+    for (; i < batch.posX.size(); ++i) {
+        if (batch.range[i] != 0.f && batch.distanceTraveled[i] > batch.range[i]) {
+            batch.expired[i] = true;
+            continue;
+        }
+
+        batch.posX[i] += batch.velX[i] * eTime;
+        batch.posY[i] += batch.velY[i] * eTime;
+        batch.distanceTraveled[i] += batch.speed[i] * eTime;
+    }
+}
+
+void ProjectileBatch_scatter(const ProjectileBatch& batch, Bucket<Projectile>& projectiles)
+{
+    for (size_t i = 0; i < batch.count; ++i) {
+        Projectile& projectile = projectiles[i];
+
+        //projectiles that were already dead are not modified
+        if (projectile.dead) continue;
+
+        if (batch.expired[i]) {
+            projectile.dead = true;
+            continue;
+        }
+
+        projectile.pos.x = batch.posX[i];
+        projectile.pos.y = batch.posY[i];
+        projectile.distanceTraveled = batch.distanceTraveled[i];
+    }
+}
+
+void ProjectileBatch_findHits(ProjectileBatch& batch, const Bucket<Projectile>& projectiles, CollisionManager& collisionManager)
+{
+    batch.collisionOrder.clear();
+    batch.hits.clear();
+
+    auto toCell = [] (float value) -> u32 {
+        return (u32) std::min(std::max(std::floor(value/PROJECTILE_BATCH_CELL_SIZE), 0.f), 65535.f);
+    };
+
+    for (size_t i = 0; i < batch.count; ++i) {
+        const Projectile& projectile = projectiles[i];
+
+        if (projectile.dead) continue;
+
+        const u32 cell = (toCell(projectile.pos.y) << 16) | toCell(projectile.pos.x);
+        batch.collisionOrder.emplace_back(cell, i);
+    }
+
+    std::sort(batch.collisionOrder.begin(), batch.collisionOrder.end());
+
+    //the broadphase is not modified while the hits are found
+    for (const auto& pair : batch.collisionOrder) {
+        float time;
+        const BroadphaseProxy* proxy = Projectile_findHit(projectiles[pair.second], batch.startPos[pair.second], collisionManager, time);
+
+        if (proxy) {
+            batch.hits.push_back({pair.second, proxy, time});
+        }
+    }
+
+    std::sort(batch.hits.begin(), batch.hits.end(), [] (const ProjectileHit& lhs, const ProjectileHit& rhs) {
+        return lhs.projectileIndex < rhs.projectileIndex;
+    });
+
+    batch.broadphaseChangeCount = collisionManager.getChangeCount();
+}
+
+void ProjectileBatch_applyHits(const ProjectileBatch& batch, Bucket<Projectile>& projectiles, const ManagersContext& context)
+{
+    size_t hitIndex = 0;
+
+    for (size_t i = 0; i < batch.count; ++i) {
+        Projectile& projectile = projectiles[i];
+
+        //same projectiles ProjectileBatch_findHits checked
+        if (projectile.dead) continue;
+
+        float tileTime;
+        const bool tileHit = Projectile_checkTileCollisions(projectile, batch.startPos[i], context, tileTime);
+
+        const BroadphaseProxy* proxy = nullptr;
+        float hitTime = 0.f;
+
+        if (hitIndex < batch.hits.size() && batch.hits[hitIndex].projectileIndex == i) {
+            proxy = batch.hits[hitIndex].proxy;
+            hitTime = batch.hits[hitIndex].time;
+
+            hitIndex++;
+        }
+
+        //a previous hit moved, created or removed entities, so the stored hit might be wrong
+        if (context.collisionManager->getChangeCount() != batch.broadphaseChangeCount) {
+            proxy = Projectile_findHit(projectile, batch.startPos[i], *context.collisionManager, hitTime);
+        }
+
+        //entities behind the wall are not hit
+        if (proxy && (!tileHit || hitTime <= tileTime)) {
+            Projectile_onHit(projectile, proxy->entity, context);
+            projectile.dead = true;
+        }
+    }
+}
@@ -3,12 +3,13 @@
 #include <SFML/System/Time.hpp>
 #include "json_parser.hpp"
 #include "collision_manager.hpp"
+#include "lag_compensation.hpp"
 #include "quadtree.hpp"
 #include "server_entity_manager.hpp"
 #include "client_entity_manager.hpp"
 #include "tilemap.hpp"
-#include "bit_stream.hpp"
 #include "unit.hpp"
+#include "entity_capabilities.hpp"
 #include "texture_ids.hpp"
 #include "buffs/reveal_buff.hpp"
 
@@ -24,6 +25,12 @@ void _BaseProjectile_loadFromJson(const rapidjson::Document& doc, ProjectileType
     projectile.movementSpeed = doc["movement_speed"].GetUint();
     projectile.range = doc["range"].GetUint();
 
+    if (doc.HasMember("position_precision")) {
+        projectile.positionPrecision = doc["position_precision"].GetFloat();
+    } else {
+        projectile.positionPrecision = DEFAULT_PROJECTILE_POSITION_PRECISION;
+    }
+
     if (doc.HasMember("destroys_tiles")) {
         projectile.destroysTiles = doc["destroys_tiles"].GetBool();
     } else {
@@ -179,13 +186,15 @@ void C_Projectile_init(C_Projectile& projectile, u8 type, const Vector2& pos, fl
     _BaseProjectile_angleInit(projectile, pos, aimAngle);
 }
 
-void Projectile_packData(const Projectile& projectile, const Projectile* prevProj, u8 teamId, CRCPacket& outPacket, const EntityManager* entityManager)
+void Projectile_packData(const Projectile& projectile, const ProjectileNetState* prevProj, u8 teamId, const Vector2u& worldSize, CRCPacket& outPacket, const EntityManager* entityManager)
 {
-    bool posXChanged = !prevProj || projectile.pos.x != prevProj->pos.x;
-    outPacket << posXChanged;
+    const float precision = projectile.positionPrecision;
+
+    QuantizedCoord posX = Quantize_coord(projectile.pos.x, prevProj ? &prevProj->pos.x : nullptr, precision);
+    outPacket << posX.changed;
 
-    bool posYChanged = !prevProj || projectile.pos.y != prevProj->pos.y;
-    outPacket << posYChanged;
+    QuantizedCoord posY = Quantize_coord(projectile.pos.y, prevProj ? &prevProj->pos.y : nullptr, precision);
+    outPacket << posY.changed;
 
     bool collisionRadiusChanged = !prevProj || projectile.collisionRadius != prevProj->collisionRadius;
     outPacket << collisionRadiusChanged;
@@ -193,12 +202,15 @@ void Projectile_packData(const Projectile& projectile, const Projectile* prevPro
     bool rotationChanged = !prevProj || projectile.rotation != prevProj->rotation;
     outPacket << rotationChanged;
 
-    if (posXChanged) {
-        outPacket << projectile.pos.x;
+    outPacket << posX.isDelta;
+    outPacket << posY.isDelta;
+
+    if (posX.changed) {
+        Quantize_packCoord(posX, worldSize.x, precision, outPacket);
     }
 
-    if (posYChanged) {
-        outPacket << projectile.pos.y;
+    if (posY.changed) {
+        Quantize_packCoord(posY, worldSize.y, precision, outPacket);
     }
 
     if (collisionRadiusChanged) {
@@ -210,24 +222,38 @@ void Projectile_packData(const Projectile& projectile, const Projectile* prevPro
     }
 }
 
-void C_Projectile_loadFromData(C_Projectile& projectile, CRCPacket& inPacket)
+void Projectile_takeNetState(const Projectile& projectile, ProjectileNetState& state)
+{
+    state.uniqueId = projectile.uniqueId;
+    state.pos = projectile.pos;
+    state.collisionRadius = projectile.collisionRadius;
+    state.rotation = projectile.rotation;
+}
+
+void C_Projectile_loadFromData(C_Projectile& projectile, const Vector2u& worldSize, CRCPacket& inPacket)
 {
     bool posXChanged;
     bool posYChanged;
     bool collisionRadiusChanged;
     bool rotationChanged;
+    bool posXDelta;
+    bool posYDelta;
 
     inPacket >> posXChanged;
     inPacket >> posYChanged;
     inPacket >> collisionRadiusChanged;
     inPacket >> rotationChanged;
+    inPacket >> posXDelta;
+    inPacket >> posYDelta;
+
+    const float precision = projectile.positionPrecision;
 
     if (posXChanged) {
-        inPacket >> projectile.pos.x;
+        Quantize_loadCoord(projectile.pos.x, posXDelta, worldSize.x, precision, inPacket);
     }
 
     if (posYChanged) {
-        inPacket >> projectile.pos.y;
+        Quantize_loadCoord(projectile.pos.y, posYDelta, worldSize.y, precision, inPacket);
     }
 
     if (collisionRadiusChanged) {
@@ -241,77 +267,160 @@ void C_Projectile_loadFromData(C_Projectile& projectile, CRCPacket& inPacket)
     }
 }
 
-void Projectile_update(Projectile& projectile, sf::Time eTime, const ManagersContext& context)
+//returns false if the projectile already traveled its range
+bool _Projectile_move(Projectile& projectile, sf::Time eTime)
 {
-    if (projectile.dead) return;
-
     //0 range means the projectile can travel infinitely
     if (projectile.range != 0 && projectile.distanceTraveled > projectile.range) {
         projectile.dead = true;
-        return;
+        return false;
     }
 
     Vector2 moveVec = projectile.vel * eTime.asSeconds();
     projectile.pos += moveVec;
     projectile.distanceTraveled += Helper_vec2length(moveVec);
 
-    const Circlef circle(projectile.pos, projectile.collisionRadius);
+    return true;
+}
 
-    u16 collidingTile = context.tileMap->getCollidingTile(circle);
+void Projectile_update(Projectile& projectile, sf::Time eTime, const ManagersContext& context)
+{
+    if (projectile.dead) return;
+
+    const Vector2 start = projectile.pos;
 
-    if (projectile.destroysTiles && (collidingTile & (TILE_BLOCK | TILE_BUSH)) != 0) {
-        //@TODO: Destroy those tiles
-        //(send it to the client or predict it??)
+    if (_Projectile_move(projectile, eTime)) {
+        Projectile_checkCollisions(projectile, start, context);
     }
+}
 
-    if ((collidingTile & (TILE_BLOCK | TILE_WALL)) != 0) {
-        //we don't return here since we want to check collision with units as well
+void Projectile_checkCollisions(Projectile& projectile, const Vector2& start, const ManagersContext& context)
+{
+    if (projectile.dead) return;
+
+    float tileTime;
+    const bool tileHit = Projectile_checkTileCollisions(projectile, start, context, tileTime);
+
+    float hitTime;
+    const BroadphaseProxy* hit = Projectile_findHit(projectile, start, *context.collisionManager, hitTime);
+
+    //entities behind the wall are not hit
+    if (hit && (!tileHit || hitTime <= tileTime)) {
+        Projectile_onHit(projectile, hit->entity, context);
+        projectile.dead = true;
+    }
+}
+
+bool Projectile_checkTileCollisions(Projectile& projectile, const Vector2& start, const ManagersContext& context, float& t)
+{
+    const Circlef circle(start, projectile.collisionRadius);
+
+    //@TODO: Destroy the blocks and bushes it went through if projectile.destroysTiles
+    //(send it to the client or predict it??)
+
+    if (context.tileMap->sweepCircle(TILE_BLOCK | TILE_WALL, circle, projectile.pos, t)) {
         projectile.dead = true;
 
         //@TODO: Some projectiles might not get destroyed when they hit a tile
         //They might bounce, or pass through
         //create function onTileHit(collidingTile) and add it to the _funcTable[PROJ_TYPE]
+        return true;
     }
 
-    auto query = context.collisionManager->getQuadtree()->QueryIntersectsRegion(BoundingBody<float>(circle));
+    return false;
+}
+
+const BroadphaseProxy* Projectile_findHit(const Projectile& projectile, const Vector2& start, CollisionManager& collisionManager, float& t)
+{
+    const BroadphaseProxy* hit = nullptr;
+    const Circlef circle(start, projectile.collisionRadius);
+
+    //bounds of the whole movement
+    const float radius = projectile.collisionRadius;
+    const sf::FloatRect bounds(std::min(start.x, projectile.pos.x) - radius, std::min(start.y, projectile.pos.y) - radius,
+                               std::abs(projectile.pos.x - start.x) + 2.f * radius, std::abs(projectile.pos.y - start.y) + 2.f * radius);
 
-    //Because of the implementation, queries can't be stopped unless EndOfQuery is true
-    bool queryDone = false;
+    collisionManager.forEachIntersecting(BoundingBody<float>(RotatingRectf(bounds)), [&] (const BroadphaseProxy& proxy) -> bool {
+        float hitTime;
 
-    while (!query.EndOfQuery()) {
-        if (queryDone) {
-            query.Next();
-            continue;
+        if (_BaseProjectile_canHitTeam(projectile, proxy.teamId) && circle.sweepIntersects(projectile.pos, proxy.body.circle, hitTime)) {
+            if (!hit || hitTime < t) {
+                hit = &proxy;
+                t = hitTime;
+            }
+
+            //nothing can be hit earlier
+            return hitTime == 0.f;
         }
 
-        u32 collisionUniqueId = query.GetCurrent()->uniqueId;
-        Entity* entity = context.entityManager->entities.atUniqueId(collisionUniqueId);
+        return false;
+    });
 
-        if (entity) {
-            if (_BaseProjectile_canHitTeam(projectile, entity->getTeamId())) {
+    return hit;
+}
+
+u32 Projectile_findRewoundHit(const Projectile& projectile, const Vector2& start, const LagCompensation& lagCompensation, sf::Time worldTime, float& t)
+{
+    u32 hitUniqueId = 0;
+    const Circlef circle(start, projectile.collisionRadius);
+
+    //bounds of the whole movement
+    const float radius = projectile.collisionRadius;
+    const sf::FloatRect bounds(std::min(start.x, projectile.pos.x) - radius, std::min(start.y, projectile.pos.y) - radius,
+                               std::abs(projectile.pos.x - start.x) + 2.f * radius, std::abs(projectile.pos.y - start.y) + 2.f * radius);
+
+    lagCompensation.forEachIntersecting(worldTime, BoundingBody<float>(RotatingRectf(bounds)), [&] (const LagCompensation::Record& record) -> bool {
+        float hitTime;
 
-                Projectile_onHit(projectile, entity, context);
-                projectile.dead = true;
-                queryDone = true;
+        if (_BaseProjectile_canHitTeam(projectile, record.teamId) && circle.sweepIntersects(projectile.pos, Circlef(record.pos, record.radius), hitTime)) {
+            if (hitUniqueId == 0 || hitTime < t) {
+                hitUniqueId = record.uniqueId;
+                t = hitTime;
             }
+
+            //nothing can be hit earlier
+            return hitTime == 0.f;
         }
 
-        query.Next();
-    }
+        return false;
+    });
+
+    return hitUniqueId;
 }
 
 void Projectile_backtrackCollisions(Projectile& projectile, const ManagersContext& context, u16 clientDelay)
 {
-    float totalDistance = ((float) clientDelay / 1000.f) * projectile.movementSpeed;
+    const sf::Time delay = sf::milliseconds(clientDelay);
+
+    if (!context.lagCompensation) {
+        //a single swept update covers the whole delay
+        Projectile_update(projectile, delay, context);
+        return;
+    }
+
+    if (projectile.dead) return;
 
-    //do no more than 5 iteration steps
-    int steps = std::min((int) (totalDistance / projectile.collisionRadius), 5);
-    sf::Time stepTime = sf::milliseconds(clientDelay/steps);
-    int i = 0;
+    const Vector2 start = projectile.pos;
 
-    while (i < steps && !projectile.dead) {
-        Projectile_update(projectile, stepTime, context);
-        i++;
+    if (!_Projectile_move(projectile, delay)) return;
+
+    float tileTime;
+    const bool tileHit = Projectile_checkTileCollisions(projectile, start, context, tileTime);
+
+    //entities are where the shooter saw them when the projectile was fired
+    const sf::Time worldTime = context.lagCompensation->getLatestTime() - delay;
+
+    float hitTime;
+    const u32 hitUniqueId = Projectile_findRewoundHit(projectile, start, *context.lagCompensation, worldTime, hitTime);
+
+    //entities behind the wall are not hit
+    if (hitUniqueId != 0 && (!tileHit || hitTime <= tileTime)) {
+        Entity* entity = context.entityManager->entities.atUniqueId(hitUniqueId);
+
+        if (entity) {
+            Projectile_onHit(projectile, entity, context);
+            projectile.dead = true;
+        }
     }
 }
 
@@ -353,9 +462,8 @@ void Projectile_onHit(Projectile& projectile, Entity* entityHit, const ManagersC
 
     Entity* shooter = context.entityManager->entities.atUniqueId(projectile.shooterUniqueId);
 
-    //dynamic_cast will go away eventually
-    Unit* unitHit = dynamic_cast<Unit*>(entityHit);
-    HealthComponent* healthComponentHit = dynamic_cast<HealthComponent*>(entityHit);
+    Unit* unitHit = Entity_getComponent<Unit>(entityHit);
+    HealthComponent* healthComponentHit = Entity_getComponent<HealthComponent>(entityHit);
 
     //deal damage
     if (healthComponentHit) {
@@ -381,7 +489,7 @@ void Projectile_onHit(Projectile& projectile, Entity* entityHit, const ManagersC
 
     //projectile hit callbacks
     if (shooter) {
-        Unit* shooterUnit = dynamic_cast<Unit*>(shooter);
+        Unit* shooterUnit = Entity_getComponent<Unit>(shooter);
 
         if (shooterUnit) {
             shooterUnit->onProjectileHit(projectile, entityHit);
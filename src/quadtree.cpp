@@ -13,6 +13,7 @@ BlocksAllocator::~BlocksAllocator() {
             assert(address_empty_pair.second == blocks_head.slots_in_a_block_);
             Block* block = address_empty_pair.first;
             delete block;
+            MemoryStats_deallocate(MEMORY_TAG_QUADTREE, sizeof(Block));
         }
     }
 }
@@ -30,6 +31,7 @@ void* BlocksAllocator::Allocate(std::size_t object_size) {
     assert(blocks_head.slots_in_a_block_ == kBlockSize / object_size);
     if (blocks_head.first_empty_slot == nullptr) {
         Block* new_block = new Block();
+        MemoryStats_allocate(MEMORY_TAG_QUADTREE, sizeof(Block));
         std::size_t empties = blocks_head.slots_in_a_block_;
         blocks_head.address_to_empty_slot_number.emplace(new_block, empties);
         blocks_head.first_empty_slot = reinterpret_cast<void*>(new_block);
@@ -126,6 +128,8 @@ void BlocksAllocator::ReleaseFreeBlocks() {
             if (address_empties_it->second >= blocks_head.slots_in_a_block_) {
                 auto prev_address_empties_it = address_empties_it;
                 address_empties_it++;
+                delete prev_address_empties_it->first;
+                MemoryStats_deallocate(MEMORY_TAG_QUADTREE, sizeof(Block));
                 blocks_head.address_to_empty_slot_number.erase(prev_address_empties_it);
             }
             else {
@@ -0,0 +1,83 @@
+#include "quantize.hpp"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+namespace {
+
+bool Quantize_needsWideSteps(u32 worldSize, float precision)
+{
+    return std::ceil(static_cast<float>(worldSize)/precision) > std::numeric_limits<u16>::max();
+}
+
+}
+
+s32 Quantize_toSteps(float value, float precision)
+{
+    //positions are never negative
+    return std::max(static_cast<s32>(std::lround(value/precision)), 0);
+}
+
+float Quantize_fromSteps(s32 steps, float precision)
+{
+    return static_cast<float>(steps) * precision;
+}
+
+QuantizedCoord Quantize_coord(float value, const float* prevValue, float precision)
+{
+    QuantizedCoord coord;
+    coord.steps = Quantize_toSteps(value, precision);
+
+    if (prevValue) {
+        const s32 diff = coord.steps - Quantize_toSteps(*prevValue, precision);
+
+        //changes smaller than the precision are not sent
+        coord.changed = (diff != 0);
+        coord.isDelta = coord.changed && diff >= std::numeric_limits<s8>::min() && diff <= std::numeric_limits<s8>::max();
+
+        if (coord.isDelta) {
+            coord.delta = static_cast<s8>(diff);
+        }
+    }
+
+    return coord;
+}
+
+void Quantize_packCoord(const QuantizedCoord& coord, u32 worldSize, float precision, CRCPacket& outPacket)
+{
+    if (coord.isDelta) {
+        outPacket << coord.delta;
+        return;
+    }
+
+    if (Quantize_needsWideSteps(worldSize, precision)) {
+        outPacket << static_cast<u32>(coord.steps);
+    } else {
+        outPacket << static_cast<u16>(std::min(coord.steps, (s32) std::numeric_limits<u16>::max()));
+    }
+}
+
+void Quantize_loadCoord(float& value, bool isDelta, u32 worldSize, float precision, CRCPacket& inPacket)
+{
+    if (isDelta) {
+        s8 delta;
+        inPacket >> delta;
+
+        value = Quantize_fromSteps(Quantize_toSteps(value, precision) + delta, precision);
+        return;
+    }
+
+    if (Quantize_needsWideSteps(worldSize, precision)) {
+        u32 steps;
+        inPacket >> steps;
+
+        value = Quantize_fromSteps(steps, precision);
+
+    } else {
+        u16 steps;
+        inPacket >> steps;
+
+        value = Quantize_fromSteps(steps, precision);
+    }
+}
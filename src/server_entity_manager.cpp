@@ -1,5 +1,7 @@
 #include "server_entity_manager.hpp"
 
+#include <SFML/System/Clock.hpp>
+
 #include "collision_manager.hpp"
 #include "tilemap.hpp"
 #include "hero.hpp"
@@ -8,41 +10,92 @@
 #include "entities/food.hpp"
 #include "entities/crate.hpp"
 
-EntityManager::EntityManager(const JsonParser* jsonParser)
+namespace {
+
+//Qualified calls so they're not virtual (all entities in the group have the same type)
+//Hooks the entity type doesn't implement are not called at all
+template<typename T>
+void EntityGroup_preUpdate(const std::vector<Entity*>& group, sf::Time eTime, const ManagersContext& context)
 {
-    loadEntityData(jsonParser);
+    if ((T::UPDATE_HOOKS & ENTITY_HOOK_PRE_UPDATE) == 0) return;
 
-    m_lastUniqueId = 0;
+    for (Entity* entity : group) {
+        static_cast<T*>(entity)->T::preUpdate(eTime, context);
+    }
+}
+
+template<typename T>
+void EntityGroup_update(const std::vector<Entity*>& group, sf::Time eTime, const ManagersContext& context)
+{
+    if ((T::UPDATE_HOOKS & ENTITY_HOOK_UPDATE) == 0) return;
+
+    for (Entity* entity : group) {
+        static_cast<T*>(entity)->T::update(eTime, context);
+    }
+}
+
+template<typename T>
+void EntityGroup_postUpdate(const std::vector<Entity*>& group, sf::Time eTime, const ManagersContext& context)
+{
+    if ((T::UPDATE_HOOKS & ENTITY_HOOK_POST_UPDATE) == 0) return;
+
+    for (Entity* entity : group) {
+        static_cast<T*>(entity)->T::postUpdate(eTime, context);
+    }
+}
 
-    m_managers.entityManager = this;
 }
 
-//constructor used if the instance is a snapshot
-EntityManager::EntityManager()
+EntityManager::EntityManager(const JsonParser* jsonParser):
+    m_interestGrid(BROADPHASE_UNIFORM_GRID)
 {
+    loadEntityData(jsonParser);
+
+    m_lastUniqueId = 0;
 
+    m_managers.entityManager = this;
 }
 
-void EntityManager::update(sf::Time eTime)
+void EntityManager::update(sf::Time eTime, UpdateTimings* timings)
 {
     int i;
+    sf::Clock clock;
 
-    for (auto it = entities.begin(); it != entities.end(); ++it) {
-        it->preUpdate(eTime, m_managers);
-    }
+    //entities created during this update are not updated until the next one
+    _groupEntitiesByType();
 
-    for (auto it = entities.begin(); it != entities.end(); ++it) {
-        it->update(eTime, m_managers);
-    }
+    #define DoEntity(class_name, type, json_id) \
+        EntityGroup_preUpdate<class_name>(m_entityGroups[ENTITY_##type], eTime, m_managers);
+    #include "entities.inc"
+    #undef DoEntity
+
+    if (timings) timings->preUpdate = clock.restart();
+
+    #define DoEntity(class_name, type, json_id) \
+        EntityGroup_update<class_name>(m_entityGroups[ENTITY_##type], eTime, m_managers);
+    #include "entities.inc"
+    #undef DoEntity
+
+    if (timings) timings->update = clock.restart();
     
-    for (i = 0; i < projectiles.firstInvalidIndex(); ++i) {
-        Projectile_update(projectiles[i], eTime, m_managers);
-    }
+    //projectiles are moved all at once and then collisions are checked
+    //(projectiles created while checking collisions are not updated until the next tick)
+    ProjectileBatch_gather(m_projectileBatch, projectiles);
+    ProjectileBatch_integrate(m_projectileBatch, eTime.asSeconds());
+    ProjectileBatch_scatter(m_projectileBatch, projectiles);
 
-    for (auto it = entities.begin(); it != entities.end();) {
-        it->postUpdate(eTime, m_managers);
+    ProjectileBatch_findHits(m_projectileBatch, projectiles, *m_managers.collisionManager);
+    ProjectileBatch_applyHits(m_projectileBatch, projectiles, m_managers);
 
-        //remove dead entities
+    if (timings) timings->projectiles = clock.restart();
+
+    #define DoEntity(class_name, type, json_id) \
+        EntityGroup_postUpdate<class_name>(m_entityGroups[ENTITY_##type], eTime, m_managers);
+    #include "entities.inc"
+    #undef DoEntity
+
+    //remove dead entities
+    for (auto it = entities.begin(); it != entities.end();) {
         if (it->isDead()) {
             it = entities.removeEntity(it);
         } else {
@@ -61,6 +114,8 @@ void EntityManager::update(sf::Time eTime)
         }
     }
 
+    if (timings) timings->postUpdate = clock.restart();
+
     //@WIP: See how we can remove entities properly in a general way (without abusing delete)
     //Taking into account that some entities might respawn depending on game mode
     //for entities that respawn (heroes) it's probably best to just move them to some other list
@@ -122,74 +177,111 @@ Entity* EntityManager::createEntity(u8 entityType, const Vector2& pos, u8 teamId
     //if the entity is initially solid, add it to the quadtree
     //@WIP: Maybe some quadtree entities start not being solid?
     if (entity->isSolid()) {
-        m_managers.collisionManager->onInsertEntity(uniqueId, pos, entity->getCollisionRadius());
+        m_managers.collisionManager->onInsertEntity(entity);
         entity->onQuadtreeInserted(m_managers);
+
+    } else {
+        //so it can still be found by interest queries
+        m_interestGrid.onInsertEntity(entity);
     }
 
     return entity;
 }
 
-void EntityManager::takeSnapshot(EntityManager* snapshot) const
+void EntityManager::queryInterestEntities(const sf::FloatRect& region, u8 teamId, std::vector<u32>& uniqueIds)
 {
-    for (auto it = entities.begin(); it != entities.end(); ++it) {
-        snapshot->entities.addEntity(it->clone());
-    }
+    uniqueIds.clear();
 
-    projectiles.copyValidDataTo(snapshot->projectiles);
+    //a bit bigger in case some entity moved since it was last updated in the quadtree
+    sf::FloatRect queryRect = region;
+    queryRect.left -= INTEREST_QUERY_SLACK;
+    queryRect.top -= INTEREST_QUERY_SLACK;
+    queryRect.width += 2.f * INTEREST_QUERY_SLACK;
+    queryRect.height += 2.f * INTEREST_QUERY_SLACK;
+
+    const BoundingBodyf queryBody = BoundingBodyf(RotatingRectf(queryRect));
+
+    auto visitor = [&] (const BroadphaseProxy& proxy) -> bool {
+        if (_shouldSendEntity(proxy.entity, teamId, region)) {
+            uniqueIds.push_back(proxy.uniqueId);
+        }
+
+        return false;
+    };
+
+    //an entity is only in one of them
+    m_managers.collisionManager->forEachIntersecting(queryBody, visitor);
+    m_interestGrid.forEachIntersecting(queryBody, visitor);
 }
 
-void EntityManager::packData(const EntityManager* snapshot, u8 teamId, u32 controlledEntityUniqueId, CRCPacket& outPacket) const
+void EntityManager::queryInterestProjectiles(const sf::FloatRect& region, std::vector<u32>& uniqueIds) const
 {
-    u16 unitsToSend = 0;
+    uniqueIds.clear();
 
-    for (auto it = entities.begin(); it != entities.end(); ++it) {
-        if (it->shouldSendToTeam(teamId)) {
-            unitsToSend++;
+    //projectiles are not in the quadtree, but they're cheap to check
+    //(we're assuming here all projectiles are visible)
+    for (int i = 0; i < projectiles.firstInvalidIndex(); ++i) {
+        const Projectile& projectile = projectiles[i];
+
+        if (NetState_isInInterest(region, projectile.pos, projectile.collisionRadius)) {
+            uniqueIds.push_back(projectile.uniqueId);
         }
     }
+}
 
-    outPacket << unitsToSend;
+void EntityManager::packEntity(u32 uniqueId, const EntityNetState* prevState, u8 teamId, CRCPacket& outPacket) const
+{
+    const Entity* entity = entities.atUniqueId(uniqueId);
 
-    for (auto it = entities.begin(); it != entities.end(); ++it) {
-        if (!it->shouldSendToTeam(teamId)) continue;
+    if (!entity) {
+        std::cout << "EntityManager::packEntity error - Invalid uniqueId" << std::endl;
+        return;
+    }
 
-        const Entity* prevEntity = nullptr;
+    //the baseline is from a different entity if it was created again with another type
+    if (prevState && prevState->type != entity->getEntityType()) {
+        prevState = nullptr;
+    }
 
-        if (snapshot) {
-            prevEntity = snapshot->entities.atUniqueId(it->getUniqueId());
-        }
+    //unique ids are usually small
+    outPacket.writeVarUint(uniqueId);
 
-        outPacket << it->getUniqueId();
+    //the client replaces its copy of the entity if it's sent in full
+    outPacket << (prevState == nullptr);
 
-        if (!prevEntity || !(prevEntity->shouldSendToTeam(teamId))) {
-            outPacket << it->getEntityType();
+    if (!prevState) {
+        outPacket << entity->getEntityType();
+    }
 
-            //pack all data again
-            prevEntity = nullptr;
-        }
+    entity->packData(prevState, teamId, m_managers.tileMap->getWorldSize(), outPacket);
+}
+
+void EntityManager::packProjectile(u32 uniqueId, const ProjectileNetState* prevProj, u8 teamId, CRCPacket& outPacket) const
+{
+    const Projectile* projectile = projectiles.atUniqueId(uniqueId);
 
-        it->packData(prevEntity, teamId, controlledEntityUniqueId, outPacket);
+    if (!projectile) {
+        std::cout << "EntityManager::packProjectile error - Invalid uniqueId" << std::endl;
+        return;
     }
 
-    //We're assuming here all projectiles are visible (which is true?)
-    outPacket << (u16) projectiles.firstInvalidIndex();
+    outPacket.writeVarUint(uniqueId);
+    outPacket << (prevProj == nullptr);
 
-    for (int i = 0; i < projectiles.firstInvalidIndex(); ++i) {
-        const Projectile& projectile = projectiles[i];
-        const Projectile* prevProj = nullptr;
+    if (!prevProj) {
+        outPacket << projectile->type;
+    }
 
-        if (snapshot) {
-            prevProj = snapshot->projectiles.atUniqueId(projectile.uniqueId);
-        }
+    Projectile_packData(*projectile, prevProj, teamId, m_managers.tileMap->getWorldSize(), outPacket, this);
+}
 
-        outPacket << projectile.uniqueId;
+void EntityManager::packControlledData(u32 controlledEntityUniqueId, CRCPacket& outPacket) const
+{
+    const Entity* entity = entities.atUniqueId(controlledEntityUniqueId);
 
-        if (!prevProj) {
-            outPacket << projectile.type;
-        }
+    if (!entity) return;
 
-        Projectile_packData(projectile, prevProj, teamId, outPacket, this);
-    }
+    entity->packControlledData(outPacket);
 }
 
 void EntityManager::allocateAll()
@@ -202,6 +294,12 @@ void EntityManager::setManagersContext(const ManagersContext& managers)
     m_managers.collisionManager = managers.collisionManager;
     m_managers.tileMap = managers.tileMap;
     m_managers.gameMode = managers.gameMode;
+    m_managers.lagCompensation = managers.lagCompensation;
+}
+
+void EntityManager::setWorldSize(const Vector2u& worldSize)
+{
+    m_interestGrid.setWorldSize(worldSize);
 }
 
 bool EntityManager::m_entitiesJsonLoaded = false;
@@ -228,7 +326,23 @@ void EntityManager::loadEntityData(const JsonParser* jsonParser)
     m_entitiesJsonLoaded = true;
 }
 
+bool EntityManager::_shouldSendEntity(const Entity* entity, u8 teamId, const sf::FloatRect& region) const
+{
+    return entity && entity->shouldSendToTeam(teamId) && NetState_isInInterest(region, entity->getPosition(), entity->getCollisionRadius());
+}
+
 inline u32 EntityManager::_getNewUniqueId()
 {
     return ++m_lastUniqueId;
 }
+
+void EntityManager::_groupEntitiesByType()
+{
+    for (std::vector<Entity*>& group : m_entityGroups) {
+        group.clear();
+    }
+
+    for (auto it = entities.begin(); it != entities.end(); ++it) {
+        m_entityGroups[it->getEntityType()].push_back(&it);
+    }
+}
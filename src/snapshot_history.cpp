@@ -0,0 +1,274 @@
+#include "snapshot_history.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <cstddef>
+#include <iterator>
+#include <new>
+
+#include "server_entity_manager.hpp"
+
+//all entities have to be included
+#include "hero.hpp"
+#include "entities/food.hpp"
+#include "entities/crate.hpp"
+
+namespace {
+
+const size_t NET_STATE_SIZES[] = {
+    #define DoEntity(class_name, type, json_id) \
+        sizeof(class_name::NetState),
+    #include "entities.inc"
+    #undef DoEntity
+};
+
+//value initialization sets everything to zero (padding included),
+//so states of the same type can be compared with memcmp
+EntityNetState* NetState_construct(u8 entityType, void* memory)
+{
+    switch (entityType) {
+        #define DoEntity(class_name, type, json_id) \
+            case ENTITY_##type: return new (memory) class_name::NetState();
+        #include "entities.inc"
+        #undef DoEntity
+
+        default:
+            return nullptr;
+    }
+}
+
+bool Entry_lessThan(const SnapshotHistory::Entry& lhs, const SnapshotHistory::Entry& rhs)
+{
+    return lhs.uniqueId < rhs.uniqueId;
+}
+
+bool ProjectileNetState_lessThan(const ProjectileNetState& lhs, const ProjectileNetState& rhs)
+{
+    return lhs.uniqueId < rhs.uniqueId;
+}
+
+}
+
+u32 SnapshotHistory::Snapshot::getId() const
+{
+    return m_id;
+}
+
+sf::Time SnapshotHistory::Snapshot::getWorldTime() const
+{
+    return m_worldTime;
+}
+
+const EntityNetState* SnapshotHistory::Snapshot::getEntity(u32 uniqueId) const
+{
+    const Entry* entry = findEntry(uniqueId);
+
+    if (!entry) return nullptr;
+
+    return m_history->m_recordPools[entry->entityType].at(entry->recordIndex);
+}
+
+const ProjectileNetState* SnapshotHistory::Snapshot::getProjectile(u32 uniqueId) const
+{
+    ProjectileNetState projectile;
+    projectile.uniqueId = uniqueId;
+
+    auto it = std::lower_bound(m_projectiles.begin(), m_projectiles.end(), projectile, ProjectileNetState_lessThan);
+
+    if (it == m_projectiles.end() || it->uniqueId != uniqueId) return nullptr;
+
+    return &(*it);
+}
+
+size_t SnapshotHistory::Snapshot::getEntityCount() const
+{
+    return m_entities.size();
+}
+
+const SnapshotHistory::Entry* SnapshotHistory::Snapshot::findEntry(u32 uniqueId) const
+{
+    Entry entry;
+    entry.uniqueId = uniqueId;
+
+    auto it = std::lower_bound(m_entities.begin(), m_entities.end(), entry, Entry_lessThan);
+
+    if (it == m_entities.end() || it->uniqueId != uniqueId) return nullptr;
+
+    return &(*it);
+}
+
+EntityNetState* SnapshotHistory::RecordPool::at(u32 index)
+{
+    return reinterpret_cast<EntityNetState*>(&states[index * stride]);
+}
+
+const EntityNetState* SnapshotHistory::RecordPool::at(u32 index) const
+{
+    return reinterpret_cast<const EntityNetState*>(&states[index * stride]);
+}
+
+SnapshotHistory::SnapshotHistory(size_t size)
+{
+    const size_t alignment = alignof(std::max_align_t);
+
+    m_recordPools.resize(ENTITY_MAX_TYPES);
+
+    for (u8 i = 0; i < ENTITY_MAX_TYPES; ++i) {
+        m_recordPools[i].stateSize = NET_STATE_SIZES[i];
+        m_recordPools[i].stride = (NET_STATE_SIZES[i] + alignment - 1)/alignment * alignment;
+    }
+
+    m_scratchState.resize(*std::max_element(std::begin(NET_STATE_SIZES), std::end(NET_STATE_SIZES)));
+
+    resize(size);
+}
+
+void SnapshotHistory::resize(size_t size)
+{
+    //we need at least 2 snapshots to be able to share records
+    if (size < 2) {
+        size = 2;
+    }
+
+    m_snapshots.clear();
+    m_snapshots.resize(size);
+
+    for (Snapshot& snapshot : m_snapshots) {
+        snapshot.m_history = this;
+    }
+
+    for (RecordPool& pool : m_recordPools) {
+        pool.states.clear();
+        pool.refCounts.clear();
+        pool.freeRecords.clear();
+    }
+}
+
+void SnapshotHistory::clear()
+{
+    for (Snapshot& snapshot : m_snapshots) {
+        releaseSnapshot(snapshot);
+    }
+}
+
+const SnapshotHistory::Snapshot& SnapshotHistory::takeSnapshot(u32 snapshotId, const sf::Time& worldTime, const EntityManager& entityManager)
+{
+    Snapshot& snapshot = m_snapshots[snapshotId % m_snapshots.size()];
+
+    //the oldest snapshot is overwritten
+    releaseSnapshot(snapshot);
+
+    const Snapshot* prevSnapshot = find(snapshotId - 1);
+
+    snapshot.m_id = snapshotId;
+    snapshot.m_worldTime = worldTime;
+
+    for (auto it = entityManager.entities.begin(); it != entityManager.entities.end(); ++it) {
+        RecordPool& pool = m_recordPools[it->getEntityType()];
+
+        EntityNetState* state = NetState_construct(it->getEntityType(), m_scratchState.data());
+        it->takeNetState(*state);
+
+        Entry entry;
+        entry.uniqueId = state->uniqueId;
+        entry.entityType = it->getEntityType();
+
+        const Entry* prevEntry = nullptr;
+
+        if (prevSnapshot) {
+            prevEntry = prevSnapshot->findEntry(state->uniqueId);
+        }
+
+        //(the type can change if an entity is created again with the same uniqueId)
+        if (prevEntry && prevEntry->entityType == entry.entityType &&
+            std::memcmp(pool.at(prevEntry->recordIndex), state, pool.stateSize) == 0)
+        {
+            //share the record if the entity didn't change
+            entry.recordIndex = prevEntry->recordIndex;
+            pool.refCounts[entry.recordIndex]++;
+
+        } else {
+            entry.recordIndex = allocateRecord(entry.entityType, state);
+        }
+
+        snapshot.m_entities.push_back(entry);
+    }
+
+    std::sort(snapshot.m_entities.begin(), snapshot.m_entities.end(), Entry_lessThan);
+
+    //projectiles change every update so there's nothing to share
+    for (int i = 0; i < entityManager.projectiles.firstInvalidIndex(); ++i) {
+        snapshot.m_projectiles.emplace_back();
+        Projectile_takeNetState(entityManager.projectiles[i], snapshot.m_projectiles.back());
+    }
+
+    std::sort(snapshot.m_projectiles.begin(), snapshot.m_projectiles.end(), ProjectileNetState_lessThan);
+
+    return snapshot;
+}
+
+const SnapshotHistory::Snapshot* SnapshotHistory::find(u32 snapshotId) const
+{
+    //0 is never a valid snapshot id
+    if (snapshotId == 0) return nullptr;
+
+    const Snapshot& snapshot = m_snapshots[snapshotId % m_snapshots.size()];
+
+    if (snapshot.m_id != snapshotId) return nullptr;
+
+    return &snapshot;
+}
+
+size_t SnapshotHistory::getSize() const
+{
+    return m_snapshots.size();
+}
+
+size_t SnapshotHistory::getRecordCount() const
+{
+    size_t count = 0;
+
+    for (const RecordPool& pool : m_recordPools) {
+        count += pool.refCounts.size() - pool.freeRecords.size();
+    }
+
+    return count;
+}
+
+u32 SnapshotHistory::allocateRecord(u8 entityType, const EntityNetState* state)
+{
+    RecordPool& pool = m_recordPools[entityType];
+    u32 index;
+
+    if (!pool.freeRecords.empty()) {
+        index = pool.freeRecords.back();
+        pool.freeRecords.pop_back();
+
+    } else {
+        index = pool.refCounts.size();
+        pool.refCounts.push_back(0);
+        pool.states.resize(pool.states.size() + pool.stride);
+    }
+
+    //NetStates are plain structs (copying them as memory is fine)
+    std::memcpy(pool.at(index), state, pool.stateSize);
+    pool.refCounts[index] = 1;
+
+    return index;
+}
+
+void SnapshotHistory::releaseSnapshot(Snapshot& snapshot)
+{
+    for (const Entry& entry : snapshot.m_entities) {
+        RecordPool& pool = m_recordPools[entry.entityType];
+
+        if (--pool.refCounts[entry.recordIndex] == 0) {
+            pool.freeRecords.push_back(entry.recordIndex);
+        }
+    }
+
+    //clear keeps the capacity so snapshots don't allocate once the buffer is warm
+    snapshot.m_entities.clear();
+    snapshot.m_projectiles.clear();
+    snapshot.m_id = 0;
+}
@@ -0,0 +1,111 @@
+#include "tick_scheduler.hpp"
+
+#include <algorithm>
+
+#ifdef __linux__
+    #include <time.h>
+    #include <errno.h>
+#else
+    #include <chrono>
+    #include <thread>
+#endif
+
+TickScheduler::TickScheduler(const sf::Time& tickRate, const sf::Time& pollInterval):
+    m_tickRate(tickRate),
+    m_pollInterval(pollInterval)
+{
+    start();
+}
+
+void TickScheduler::setTickRate(const sf::Time& tickRate)
+{
+    m_tickRate = tickRate;
+}
+
+const sf::Time& TickScheduler::getTickRate() const
+{
+    return m_tickRate;
+}
+
+void TickScheduler::setPollInterval(const sf::Time& pollInterval)
+{
+    m_pollInterval = pollInterval;
+}
+
+void TickScheduler::start()
+{
+    m_nextTick = now();
+}
+
+bool TickScheduler::waitForTick()
+{
+    sf::Time currentTime = now();
+
+    if (currentTime < m_nextTick) {
+        //with no poll interval we only wake up for ticks
+        const sf::Time wakeTime = (m_pollInterval > sf::Time::Zero ? std::min(m_nextTick, currentTime + m_pollInterval) : m_nextTick);
+
+        sleepUntil(wakeTime);
+        currentTime = now();
+
+        if (currentTime < m_nextTick) return false;
+    }
+
+    const sf::Time jitter = currentTime - m_nextTick;
+
+    m_stats.ticks++;
+    m_stats.totalJitter += jitter;
+    m_stats.maxJitter = std::max(m_stats.maxJitter, jitter);
+
+    if (jitter >= m_tickRate) {
+        m_stats.overruns++;
+    }
+
+    m_nextTick += m_tickRate;
+
+    return true;
+}
+
+const TickScheduler::Stats& TickScheduler::getStats() const
+{
+    return m_stats;
+}
+
+void TickScheduler::resetStats()
+{
+    m_stats = Stats();
+}
+
+sf::Time TickScheduler::now()
+{
+#ifdef __linux__
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return sf::microseconds(static_cast<sf::Int64>(time.tv_sec) * 1000000 + time.tv_nsec/1000);
+#else
+    auto duration = std::chrono::steady_clock::now().time_since_epoch();
+
+    return sf::microseconds(std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+#endif
+}
+
+void TickScheduler::sleepUntil(const sf::Time& time)
+{
+#ifdef __linux__
+    const sf::Int64 microseconds = time.asMicroseconds();
+
+    timespec deadline;
+    deadline.tv_sec = microseconds/1000000;
+    deadline.tv_nsec = (microseconds % 1000000) * 1000;
+
+    //absolute deadline, so it can be resumed if a signal interrupts it
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR) {}
+#else
+    const sf::Time duration = time - now();
+
+    if (duration > sf::Time::Zero) {
+        std::this_thread::sleep_for(std::chrono::microseconds(duration.asMicroseconds()));
+    }
+#endif
+}
@@ -1,6 +1,8 @@
 #include "tilemap.hpp"
 
 #include <iostream>
+#include <cmath>
+#include <limits>
 #include "paths.hpp"
 
 TileMap::TileMap(u16 tileSize, u16 tileScale)
@@ -9,11 +11,11 @@ TileMap::TileMap(u16 tileSize, u16 tileScale)
     m_tileScale = tileScale;
 }
 
-void TileMap::loadFromFile(const std::string& filename)
+void TileMap::loadFromFile(const std::string& filename, const std::string& mapsPath)
 {
     sf::Image image;
 
-    if (!image.loadFromFile(MAPS_PATH + filename + "." + MAP_FILENAME_EXT)) {
+    if (!image.loadFromFile(mapsPath + filename + "." + MAP_FILENAME_EXT)) {
         std::cout << "TileMap::loadFromFile error - Invalid filename" << std::endl;
         return;
     }
@@ -104,6 +106,73 @@ bool TileMap::getCollidingTileRect(u16 tileFlags, const Circlef& circle, sf::Flo
     return _collidingContained_impl(false, tileFlags, circle, &tileRect, nullptr);
 }
 
+bool TileMap::sweepCircle(u16 tileFlags, const Circlef& circle, const Vector2& end, float& t) const
+{
+    const float tileSize = m_tileSize * m_tileScale;
+
+    //tiles the circle can touch while its center is in a tile
+    const int reach = (int) std::ceil(circle.radius/tileSize);
+
+    const Vector2 movement = end - circle.center;
+
+    Vector2i tile((int) std::floor(circle.center.x/tileSize), (int) std::floor(circle.center.y/tileSize));
+    const Vector2i step(movement.x > 0.f ? 1 : -1, movement.y > 0.f ? 1 : -1);
+
+    //fraction of the movement until the next tile border (DDA)
+    Vector2 nextTime;
+    Vector2 deltaTime;
+
+    if (movement.x != 0.f) {
+        nextTime.x = ((tile.x + (step.x > 0 ? 1 : 0)) * tileSize - circle.center.x)/movement.x;
+        deltaTime.x = tileSize/std::abs(movement.x);
+    } else {
+        nextTime.x = std::numeric_limits<float>::infinity();
+        deltaTime.x = nextTime.x;
+    }
+
+    if (movement.y != 0.f) {
+        nextTime.y = ((tile.y + (step.y > 0 ? 1 : 0)) * tileSize - circle.center.y)/movement.y;
+        deltaTime.y = tileSize/std::abs(movement.y);
+    } else {
+        nextTime.y = std::numeric_limits<float>::infinity();
+        deltaTime.y = nextTime.y;
+    }
+
+    bool hit = false;
+
+    while (true) {
+        for (int i = tile.x - reach; i <= tile.x + reach; ++i) {
+            for (int j = tile.y - reach; j <= tile.y + reach; ++j) {
+                if (i < 0 || j < 0 || i >= (int) m_size.x || j >= (int) m_size.y) continue;
+                if ((m_tiles[i][j] & tileFlags) == 0) continue;
+
+                float tileTime;
+                const sf::FloatRect rect(i * tileSize, j * tileSize, tileSize, tileSize);
+
+                if (circle.sweepIntersects(end, rect, tileTime) && (!hit || tileTime < t)) {
+                    hit = true;
+                    t = tileTime;
+                }
+            }
+        }
+
+        const float exitTime = std::min(nextTime.x, nextTime.y);
+
+        //tiles checked later can't be hit before this one
+        if ((hit && t <= exitTime) || exitTime > 1.f) break;
+
+        if (nextTime.x < nextTime.y) {
+            tile.x += step.x;
+            nextTime.x += deltaTime.x;
+        } else {
+            tile.y += step.y;
+            nextTime.y += deltaTime.y;
+        }
+    }
+
+    return hit;
+}
+
 TileType TileMap::getTile(u16 i, u16 j) const
 {
     return static_cast<TileType>(m_tiles[i][j]);
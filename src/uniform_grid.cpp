@@ -0,0 +1,105 @@
+#include "uniform_grid.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+UniformGrid::UniformGrid()
+{
+    //a single cell until the size of the world is known
+    resize(Vector2u(0, 0), DEFAULT_GRID_CELL_SIZE);
+}
+
+void UniformGrid::resize(const Vector2u& worldSize, float cellSize)
+{
+    m_cellSize = cellSize;
+    m_columns = std::max(1, (int) std::ceil((float) worldSize.x/cellSize));
+    m_rows = std::max(1, (int) std::ceil((float) worldSize.y/cellSize));
+
+    m_cells.clear();
+    m_cells.resize(m_columns * m_rows);
+}
+
+void UniformGrid::insert(BroadphaseProxy* proxy)
+{
+    proxy->gridCells = _getCellRange(BoundingBodyf(proxy->body.circle).rect.getNonRotatingRect());
+
+    _addToCells(proxy);
+}
+
+void UniformGrid::update(BroadphaseProxy* proxy)
+{
+    const GridCellRange cells = _getCellRange(BoundingBodyf(proxy->body.circle).rect.getNonRotatingRect());
+
+    if (!_equals(cells, proxy->gridCells)) {
+        _removeFromCells(proxy);
+        proxy->gridCells = cells;
+        _addToCells(proxy);
+    }
+}
+
+void UniformGrid::remove(BroadphaseProxy* proxy)
+{
+    _removeFromCells(proxy);
+}
+
+void UniformGrid::clear()
+{
+    for (auto& cell : m_cells) {
+        cell.clear();
+    }
+}
+
+float UniformGrid::getCellSize() const
+{
+    return m_cellSize;
+}
+
+GridCellRange UniformGrid::_getCellRange(const sf::FloatRect& bounds) const
+{
+    auto toCell = [this] (float value, int cellCount) -> int {
+        return std::min(std::max((int) std::floor(value/m_cellSize), 0), cellCount - 1);
+    };
+
+    GridCellRange range;
+    range.left = toCell(bounds.left, m_columns);
+    range.top = toCell(bounds.top, m_rows);
+    range.right = toCell(bounds.left + bounds.width, m_columns);
+    range.bottom = toCell(bounds.top + bounds.height, m_rows);
+
+    return range;
+}
+
+bool UniformGrid::_equals(const GridCellRange& lhs, const GridCellRange& rhs)
+{
+    return lhs.left == rhs.left && lhs.top == rhs.top && lhs.right == rhs.right && lhs.bottom == rhs.bottom;
+}
+
+void UniformGrid::_addToCells(BroadphaseProxy* proxy)
+{
+    const GridCellRange& range = proxy->gridCells;
+
+    for (int y = range.top; y <= range.bottom; ++y) {
+        for (int x = range.left; x <= range.right; ++x) {
+            m_cells[y * m_columns + x].push_back(proxy);
+        }
+    }
+}
+
+void UniformGrid::_removeFromCells(BroadphaseProxy* proxy)
+{
+    const GridCellRange& range = proxy->gridCells;
+
+    for (int y = range.top; y <= range.bottom; ++y) {
+        for (int x = range.left; x <= range.right; ++x) {
+            auto& cell = m_cells[y * m_columns + x];
+
+            //cells only hold a few entities
+            auto it = std::find(cell.begin(), cell.end(), proxy);
+
+            if (it != cell.end()) {
+                *it = cell.back();
+                cell.pop_back();
+            }
+        }
+    }
+}
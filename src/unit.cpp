@@ -1,7 +1,8 @@
 #include "unit.hpp"
 
+#include "entity_capabilities.hpp"
+
 #include "texture_ids.hpp"
-#include "bit_stream.hpp"
 #include "tilemap.hpp"
 #include "client_entity_manager.hpp"
 #include "server_entity_manager.hpp"
@@ -119,7 +120,7 @@ void _UnitBase::loadFromJson(const rapidjson::Document& doc)
 
 Unit* Unit::clone() const
 {
-    return new Unit(*this);
+    return new (m_type) Unit(*this);
 }
 
 void Unit::loadFromJson(const rapidjson::Document& doc)
@@ -163,7 +164,7 @@ void Unit::update(sf::Time eTime, const ManagersContext& context)
 
     //it's important to check every update in case the unit has moved using abilities or something else instead of input
     if (m_pos != m_prevPos || m_collisionRadius != m_prevCollisionRadius) {
-        context.collisionManager->onUpdateEntity(m_uniqueId, m_pos, m_collisionRadius);
+        context.collisionManager->onUpdateEntity(this);
 
         m_prevPos = m_pos;
         m_prevCollisionRadius = m_collisionRadius;
@@ -176,20 +177,11 @@ void Unit::update(sf::Time eTime, const ManagersContext& context)
     //reveal of all units inside true sight radius
     //we also send units slightly farther away so revealing them looks smooth on the client
     Circlef trueSightCircle(m_pos, (float) m_trueSightRadius + 100.f);
-    auto query = context.collisionManager->getQuadtree()->QueryIntersectsRegion(BoundingBody<float>(trueSightCircle));
-
-    while (!query.EndOfQuery()) {
-        Entity* revealedEntity = context.entityManager->entities.atUniqueId(query.GetCurrent()->uniqueId);
-
+    context.collisionManager->forEachIntersecting(BoundingBody<float>(trueSightCircle), [&] (const BroadphaseProxy& proxy) -> bool {
         //we don't need to reveal units of the same team
-        if (!revealedEntity || revealedEntity->getTeamId() == m_teamId) {
-            query.Next();
-            continue;
-        }
+        if (proxy.teamId == m_teamId) return false;
 
-        //@TODO: Maybe we should change this dynamic_cast using some sort of virtual function or component flags
-        //Only if this could be bottlenecking performance
-        InvisibleComponent* invisComp = dynamic_cast<InvisibleComponent*>(revealedEntity);
+        InvisibleComponent* invisComp = Entity_getComponent<InvisibleComponent>(proxy.entity);
 
         if (invisComp) {
             if (!invisComp->shouldBeHiddenFrom(*this)) {
@@ -204,8 +196,8 @@ void Unit::update(sf::Time eTime, const ManagersContext& context)
             invisComp->markToSend(m_teamId);
         }
 
-        query.Next();
-    }
+        return false;
+    });
 
     BuffHolderComponent::onUpdate(eTime);
 }
@@ -215,7 +207,7 @@ void Unit::preUpdate(sf::Time eTime, const ManagersContext& context)
     //reset parameters
     resetInvisibleFlags();
     m_status.preUpdate();
-    m_solid = true;
+    setSolid(true);
 
     m_movementSpeed = m_baseMovementSpeed;
 
@@ -240,49 +232,52 @@ void Unit::postUpdate(sf::Time eTime, const ManagersContext& context)
     checkDead(context);
 }
 
-void Unit::packData(const Entity* prevEntity, u8 teamId, u32 controlledEntityUniqueId, CRCPacket& outPacket) const
+void Unit::packData(const EntityNetState* prevState, u8 teamId, const Vector2u& worldSize, CRCPacket& outPacket) const
 {
-    const Unit* prevUnit = static_cast<const Unit*>(prevEntity);
-    
+    const UnitNetState* prevUnit = static_cast<const UnitNetState*>(prevState);
+
     outPacket << isInvisible();
     outPacket << isSolid();
 
     m_status.packData(outPacket);
 
-    bool posXChanged = !prevUnit || m_pos.x != prevUnit->getPosition().x;
-    outPacket << posXChanged;
+    QuantizedCoord posX = Quantize_coord(m_pos.x, prevState ? &prevState->pos.x : nullptr, m_positionPrecision);
+    outPacket << posX.changed;
 
-    bool posYChanged = !prevUnit || m_pos.y != prevUnit->getPosition().y;
-    outPacket << posYChanged;
+    QuantizedCoord posY = Quantize_coord(m_pos.y, prevState ? &prevState->pos.y : nullptr, m_positionPrecision);
+    outPacket << posY.changed;
 
-    bool teamIdChanged = !prevUnit || teamId != prevUnit->getTeamId();
+    bool teamIdChanged = !prevState || teamId != prevState->teamId;
     outPacket << teamIdChanged;
 
-    bool flyingHeightChanged = !prevUnit || m_flyingHeight != prevUnit->getFlyingHeight();
+    bool flyingHeightChanged = !prevState || m_flyingHeight != prevState->flyingHeight;
     outPacket << flyingHeightChanged;
     
-    bool maxHealthChanged = !prevUnit || m_maxHealth != prevUnit->getMaxHealth();
+    bool maxHealthChanged = !prevState || m_maxHealth != prevUnit->maxHealth;
     outPacket << maxHealthChanged;
 
-    bool healthChanged = !prevUnit || m_health != prevUnit->getHealth();
+    bool healthChanged = !prevState || m_health != prevUnit->health;
     outPacket << healthChanged;
 
-    bool aimAngleChanged = !prevUnit || m_aimAngle != prevUnit->getAimAngle();
+    bool aimAngleChanged = !prevState || m_aimAngle != prevUnit->aimAngle;
     outPacket << aimAngleChanged;
 
-    bool collisionRadiusChanged = !prevUnit || m_collisionRadius != prevUnit->getCollisionRadius();
+    bool collisionRadiusChanged = !prevState || m_collisionRadius != prevState->collisionRadius;
     outPacket << collisionRadiusChanged;
 
     //tell the client if the unit is being revealed by some other method that's not close proximity
     outPacket << (isRevealedForTeam(teamId) && !isMarkedToSendCloserForTeam(teamId));
 
+    outPacket << posX.isDelta;
+    outPacket << posY.isDelta;
+
     //send the data if it has changed
-    if (posXChanged) {
-        outPacket << m_pos.x;
+    if (posX.changed) {
+        Quantize_packCoord(posX, worldSize.x, m_positionPrecision, outPacket);
     }
 
-    if (posYChanged) {
-        outPacket << m_pos.y;
+    if (posY.changed) {
+        Quantize_packCoord(posY, worldSize.y, m_positionPrecision, outPacket);
     }
 
     if (teamIdChanged) {
@@ -308,15 +303,16 @@ void Unit::packData(const Entity* prevEntity, u8 teamId, u32 controlledEntityUni
     if (collisionRadiusChanged) {
         outPacket << m_collisionRadius;
     }
+}
 
-    if (m_uniqueId == controlledEntityUniqueId) {
-        outPacket << m_movementSpeed;
+void Unit::packControlledData(CRCPacket& outPacket) const
+{
+    outPacket << m_movementSpeed;
 
-        m_primaryFire->packData(outPacket);
-        m_secondaryFire->packData(outPacket);
-        m_altAbility->packData(outPacket);
-        m_ultimate->packData(outPacket);
-    }
+    m_primaryFire->packData(outPacket);
+    m_secondaryFire->packData(outPacket);
+    m_altAbility->packData(outPacket);
+    m_ultimate->packData(outPacket);
 }
 
 float Unit::getDamageMultiplier() const
@@ -376,6 +372,16 @@ void Unit::applyInput(const PlayerInput& input, const ManagersContext& context,
     }
 }
 
+void Unit::takeNetState(EntityNetState& state) const
+{
+    Entity::takeNetState(state);
+
+    UnitNetState& unitState = static_cast<UnitNetState&>(state);
+    unitState.health = m_health;
+    unitState.maxHealth = m_maxHealth;
+    unitState.aimAngle = m_aimAngle;
+}
+
 bool Unit::shouldSendToTeam(u8 teamId) const
 {
     return isVisibleForTeam(teamId) || isMarkedToSendForTeam(teamId);
@@ -418,27 +424,19 @@ void Unit::moveColliding(Vector2 newPos, const ManagersContext& context, bool fo
     if (m_solid) {      
         const Circlef circle(newPos, m_collisionRadius);
 
-        auto query = context.collisionManager->getQuadtree()->QueryIntersectsRegion(BoundingBody<float>(circle));
-
-        while (!query.EndOfQuery()) {
-            u32 collisionUniqueId = query.GetCurrent()->uniqueId;
-            // const Unit* collisionUnit = context.entityManager->units.atUniqueId(collisionUniqueId);
-
-            const Entity* collisionEntity = context.entityManager->entities.atUniqueId(collisionUniqueId);
+        context.collisionManager->forEachIntersecting(BoundingBody<float>(circle), [&] (const BroadphaseProxy& proxy) -> bool {
+            //same as canCollide (this unit is solid)
+            if (proxy.uniqueId == m_uniqueId || !proxy.solid) return false;
 
-            if (collisionEntity) {
-                if (canCollide(*collisionEntity)) {
-                    float distance = Helper_vec2length(collisionEntity->getPosition() - newPos);
+            float distance = Helper_vec2length(proxy.entity->getPosition() - newPos);
 
-                    if (!closestEntity || distance < closestDistance) {
-                        closestEntity = collisionEntity;
-                        closestDistance = distance;
-                    }
-                }
+            if (!closestEntity || distance < closestDistance) {
+                closestEntity = proxy.entity;
+                closestDistance = distance;
             }
 
-            query.Next();
-        }
+            return false;
+        });
 
         if (closestEntity) {
             newPos += _moveColliding_impl(m_pos, newPos, m_collisionRadius, *closestEntity);
@@ -447,7 +445,7 @@ void Unit::moveColliding(Vector2 newPos, const ManagersContext& context, bool fo
 
     m_pos = moveCollidingTilemap_impl(m_pos, newPos, m_collisionRadius, context.tileMap);
 
-    context.collisionManager->onUpdateEntity(m_uniqueId, m_pos, m_collisionRadius);
+    context.collisionManager->onUpdateEntity(this);
 }
 
 void Unit::checkDead(const ManagersContext& context)
@@ -463,7 +461,7 @@ void Unit::checkDead(const ManagersContext& context)
             Entity* entity = context.entityManager->entities.atUniqueId(killerUniqueId);
 
             if (entity) {
-                Unit* unit = dynamic_cast<Unit*>(entity);
+                Unit* unit = Entity_getComponent<Unit>(entity);
 
                 if (unit) {
                     unit->onEntityKill(this);
@@ -475,7 +473,7 @@ void Unit::checkDead(const ManagersContext& context)
 
 C_Unit* C_Unit::clone() const
 {
-    return new C_Unit(*this);
+    return new (m_type) C_Unit(*this);
 }
 
 void C_Unit::loadFromJson(const rapidjson::Document& doc, u16 textureId, const Context& context)
@@ -496,7 +494,7 @@ void C_Unit::update(sf::Time eTime, const C_ManagersContext& context)
 
 }
 
-void C_Unit::loadFromData(u32 controlledEntityUniqueId, CRCPacket& inPacket, CasterSnapshot& casterSnapshot)
+void C_Unit::loadFromData(const Vector2u& worldSize, CRCPacket& inPacket, CasterSnapshot& casterSnapshot)
 {
     bool posXChanged;
     bool posYChanged;
@@ -507,6 +505,8 @@ void C_Unit::loadFromData(u32 controlledEntityUniqueId, CRCPacket& inPacket, Cas
     bool aimAngleChanged;
     bool collisionRadiusChanged;
     bool serverRevealed;
+    bool posXDelta;
+    bool posYDelta;
 
     inPacket >> m_invisible;
     inPacket >> m_solid;
@@ -523,14 +523,17 @@ void C_Unit::loadFromData(u32 controlledEntityUniqueId, CRCPacket& inPacket, Cas
     inPacket >> collisionRadiusChanged;
     inPacket >> serverRevealed;
 
+    inPacket >> posXDelta;
+    inPacket >> posYDelta;
+
     setServerRevealed(serverRevealed);
 
     if (posXChanged) {
-        inPacket >> m_pos.x;
+        Quantize_loadCoord(m_pos.x, posXDelta, worldSize.x, m_positionPrecision, inPacket);
     }
 
     if (posYChanged) {
-        inPacket >> m_pos.y;
+        Quantize_loadCoord(m_pos.y, posYDelta, worldSize.y, m_positionPrecision, inPacket);
     }
 
     if (teamIdChanged) {
@@ -558,12 +561,13 @@ void C_Unit::loadFromData(u32 controlledEntityUniqueId, CRCPacket& inPacket, Cas
     if (collisionRadiusChanged) {
         inPacket >> m_collisionRadius;
     }
+}
 
-    if (m_uniqueId == controlledEntityUniqueId) {
-        inPacket >> m_movementSpeed;
+void C_Unit::loadControlledData(CRCPacket& inPacket, CasterSnapshot& casterSnapshot)
+{
+    inPacket >> m_movementSpeed;
 
-        casterSnapshot.loadFromData(inPacket);
-    }
+    casterSnapshot.loadFromData(inPacket);
 }
 
 void C_Unit::interpolate(const C_Entity* prevEntity, const C_Entity* nextEntity, double t, double d, bool isControlled)
@@ -654,7 +658,7 @@ void C_Unit::updateLocallyVisible(const C_ManagersContext& context)
 void C_Unit::localReveal(C_Entity* entity)
 {
     //@WIP: We should actually reveal C_InvisibleComponent entities
-    C_Unit* unit = dynamic_cast<C_Unit*>(entity);
+    C_Unit* unit = C_Entity_getComponent<C_Unit>(entity);
 
     if (unit) {
         if (unit->isLocallyHidden() && !unit->shouldBeHiddenFrom(*this)) {
@@ -0,0 +1,114 @@
+#include "worker_pool.hpp"
+
+WorkerPool::WorkerPool(size_t threadCount):
+    m_function(nullptr),
+    m_jobCount(0),
+    m_nextJob(0),
+    m_activeWorkers(0),
+    m_generation(0),
+    m_stop(false)
+{
+    resize(threadCount);
+}
+
+WorkerPool::~WorkerPool()
+{
+    stopWorkers();
+}
+
+void WorkerPool::resize(size_t threadCount)
+{
+    stopWorkers();
+
+    m_stop = false;
+
+    for (size_t i = 0; i < threadCount; ++i) {
+        //the generation is passed so workers don't miss a loop started before they run
+        m_threads.emplace_back(&WorkerPool::workerLoop, this, m_generation);
+    }
+}
+
+size_t WorkerPool::getThreadCount() const
+{
+    return m_threads.size();
+}
+
+void WorkerPool::parallelFor(size_t count, const std::function<void(size_t)>& function)
+{
+    if (count == 0) return;
+
+    //not worth waking up the workers
+    if (m_threads.empty() || count == 1) {
+        for (size_t i = 0; i < count; ++i) {
+            function(i);
+        }
+
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_function = &function;
+        m_jobCount = count;
+        m_nextJob = 0;
+        m_activeWorkers = m_threads.size();
+        m_generation++;
+    }
+
+    m_workCondition.notify_all();
+
+    runJobs();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCondition.wait(lock, [this] () {return m_activeWorkers == 0;});
+
+    m_function = nullptr;
+}
+
+void WorkerPool::workerLoop(u32 generation)
+{
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_workCondition.wait(lock, [this, generation] () {return m_stop || m_generation != generation;});
+
+            if (m_stop) return;
+
+            generation = m_generation;
+        }
+
+        runJobs();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (--m_activeWorkers == 0) {
+            m_doneCondition.notify_one();
+        }
+    }
+}
+
+void WorkerPool::runJobs()
+{
+    size_t i;
+
+    while ((i = m_nextJob++) < m_jobCount) {
+        (*m_function)(i);
+    }
+}
+
+void WorkerPool::stopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+
+    m_workCondition.notify_all();
+
+    for (std::thread& thread : m_threads) {
+        thread.join();
+    }
+
+    m_threads.clear();
+}
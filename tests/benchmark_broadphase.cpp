@@ -0,0 +1,254 @@
+#include <SFML/System/Clock.hpp>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <cstdlib>
+
+#include "../include/defines.hpp"
+#include "../include/collision_manager.hpp"
+
+//Compares the broadphase backends of CollisionManager with a workload similar to a match
+//(every entity moves each tick, then each one queries its surroundings)
+//It also compares the query APIs of the quadtree (iterator, visitor and collect)
+//Usage: mandarina_benchmark_broadphase [entities] [ticks] [world size]
+
+struct MovingEntity {
+    u32 uniqueId;
+    Vector2 pos;
+    Vector2 vel;
+    u8 radius;
+
+    BroadphaseProxy proxy;
+};
+
+struct BenchmarkResult {
+    std::string name;
+    sf::Int64 insertTime = 0;
+    sf::Int64 updateTime = 0;
+    sf::Int64 queryTime = 0;
+
+    //has to be the same for all backends
+    size_t hits = 0;
+};
+
+std::vector<MovingEntity> createEntities(size_t count, float worldSize)
+{
+    std::vector<MovingEntity> entities(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        MovingEntity& entity = entities[i];
+
+        entity.uniqueId = i + 1;
+        entity.radius = 20 + rand() % 30;
+        entity.pos.x = static_cast<float>(rand() % (int) worldSize);
+        entity.pos.y = static_cast<float>(rand() % (int) worldSize);
+
+        //around the speed of a hero in a 30 Hz tick
+        entity.vel.x = static_cast<float>(rand() % 21 - 10);
+        entity.vel.y = static_cast<float>(rand() % 21 - 10);
+    }
+
+    return entities;
+}
+
+void moveEntity(MovingEntity& entity, float worldSize)
+{
+    entity.pos += entity.vel;
+
+    if (entity.pos.x < 0.f || entity.pos.x > worldSize) entity.vel.x = -entity.vel.x;
+    if (entity.pos.y < 0.f || entity.pos.y > worldSize) entity.vel.y = -entity.vel.y;
+}
+
+BenchmarkResult runBenchmark(const std::string& name, BroadphaseType broadphaseType, std::vector<MovingEntity> entities, int ticks, float worldSize)
+{
+    BenchmarkResult result;
+    result.name = name;
+
+    CollisionManager collisionManager(broadphaseType);
+    collisionManager.setWorldSize(Vector2u(worldSize, worldSize));
+
+    sf::Clock clock;
+
+    for (MovingEntity& entity : entities) {
+        entity.proxy.uniqueId = entity.uniqueId;
+        entity.proxy.body = BoundingBodyf(Circlef(entity.pos, entity.radius));
+
+        collisionManager.insertProxy(&entity.proxy);
+    }
+
+    result.insertTime = clock.restart().asMicroseconds();
+
+    for (int i = 0; i < ticks; ++i) {
+        clock.restart();
+
+        for (MovingEntity& entity : entities) {
+            moveEntity(entity, worldSize);
+
+            entity.proxy.body.circle.center = entity.pos;
+            collisionManager.updateProxy(&entity.proxy);
+        }
+
+        result.updateTime += clock.restart().asMicroseconds();
+
+        for (const MovingEntity& entity : entities) {
+            //collision against close units
+            collisionManager.forEachIntersecting(BoundingBodyf(Circlef(entity.pos, entity.radius)), [&] (const BroadphaseProxy& proxy) -> bool {
+                result.hits++;
+                return false;
+            });
+
+            //true sight (much bigger radius)
+            if (entity.uniqueId % 8 == 0) {
+                collisionManager.forEachIntersecting(BoundingBodyf(Circlef(entity.pos, 400.f)), [&] (const BroadphaseProxy& proxy) -> bool {
+                    result.hits++;
+                    return false;
+                });
+            }
+        }
+
+        result.queryTime += clock.restart().asMicroseconds();
+    }
+
+    return result;
+}
+
+enum QueryMode {
+    QUERY_ITERATOR,
+    QUERY_FOR_EACH,
+    QUERY_COLLECT
+};
+
+//every entity queries its own circle, firstHit only needs one entity (like projectiles)
+BenchmarkResult runQueryBenchmark(const std::string& name, QueryMode mode, bool firstHit, const std::vector<MovingEntity>& entities, int ticks)
+{
+    BenchmarkResult result;
+    result.name = name;
+
+    QuadtreeType quadtree;
+    std::vector<BroadphaseProxy> proxies(entities.size());
+
+    for (size_t i = 0; i < entities.size(); ++i) {
+        proxies[i].uniqueId = entities[i].uniqueId;
+        proxies[i].body = BoundingBodyf(Circlef(entities[i].pos, entities[i].radius));
+
+        quadtree.Insert(&proxies[i]);
+    }
+
+    std::vector<BroadphaseProxy*> collected;
+    sf::Clock clock;
+
+    for (int i = 0; i < ticks; ++i) {
+        for (const MovingEntity& entity : entities) {
+            const BoundingBodyf region(Circlef(entity.pos, entity.radius));
+
+            if (mode == QUERY_ITERATOR) {
+                auto query = quadtree.QueryIntersectsRegion(region);
+                bool found = false;
+
+                //the iterator can't be stopped
+                while (!query.EndOfQuery()) {
+                    if (!firstHit || !found) {
+                        result.hits++;
+                        found = true;
+                    }
+
+                    query.Next();
+                }
+
+            } else if (mode == QUERY_FOR_EACH) {
+                quadtree.ForEachIntersecting(region, [&] (BroadphaseProxy* proxy) -> bool {
+                    result.hits++;
+                    return firstHit;
+                });
+
+            } else {
+                quadtree.CollectIntersecting(region, collected);
+                result.hits += firstHit ? std::min(collected.size(), (size_t) 1) : collected.size();
+            }
+        }
+    }
+
+    result.queryTime = clock.restart().asMicroseconds();
+
+    return result;
+}
+
+void printResult(const BenchmarkResult& result, int ticks)
+{
+    std::cout << std::left << std::setw(12) << result.name << std::right
+              << std::setw(12) << result.insertTime
+              << std::setw(12) << result.updateTime/ticks
+              << std::setw(12) << result.queryTime/ticks
+              << std::setw(14) << result.hits << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t entityCount = 2000;
+    int ticks = 300;
+    float worldSize = 8000.f;
+
+    if (argc > 1) entityCount = std::atoi(argv[1]);
+    if (argc > 2) ticks = std::atoi(argv[2]);
+    if (argc > 3) worldSize = static_cast<float>(std::atoi(argv[3]));
+
+    //same entities for every backend
+    srand(1);
+    const std::vector<MovingEntity> entities = createEntities(entityCount, worldSize);
+
+    std::vector<BenchmarkResult> results;
+    results.push_back(runBenchmark("quadtree", BROADPHASE_QUADTREE, entities, ticks, worldSize));
+    results.push_back(runBenchmark("grid", BROADPHASE_UNIFORM_GRID, entities, ticks, worldSize));
+
+    std::cout << "Entities: " << entityCount << " - Ticks: " << ticks << " - World size: " << worldSize << std::endl << std::endl;
+
+    std::cout << std::left << std::setw(12) << "broadphase" << std::right
+              << std::setw(12) << "insert (us)" << std::setw(12) << "update (us)"
+              << std::setw(12) << "query (us)" << std::setw(14) << "hits" << std::endl;
+
+    for (const BenchmarkResult& result : results) {
+        printResult(result, ticks);
+    }
+
+    //entities don't move here, only the query is measured
+    std::vector<BenchmarkResult> queryResults;
+    queryResults.push_back(runQueryBenchmark("iterator", QUERY_ITERATOR, false, entities, ticks));
+    queryResults.push_back(runQueryBenchmark("foreach", QUERY_FOR_EACH, false, entities, ticks));
+    queryResults.push_back(runQueryBenchmark("collect", QUERY_COLLECT, false, entities, ticks));
+
+    std::vector<BenchmarkResult> firstHitResults;
+    firstHitResults.push_back(runQueryBenchmark("iterator", QUERY_ITERATOR, true, entities, ticks));
+    firstHitResults.push_back(runQueryBenchmark("foreach", QUERY_FOR_EACH, true, entities, ticks));
+
+    std::cout << std::endl << std::left << std::setw(18) << "quadtree query" << std::right
+              << std::setw(12) << "query (us)" << std::setw(14) << "hits" << std::endl;
+
+    for (const BenchmarkResult& result : queryResults) {
+        std::cout << std::left << std::setw(18) << result.name << std::right
+                  << std::setw(12) << result.queryTime/ticks << std::setw(14) << result.hits << std::endl;
+    }
+
+    for (const BenchmarkResult& result : firstHitResults) {
+        std::cout << std::left << std::setw(18) << result.name + " (first)" << std::right
+                  << std::setw(12) << result.queryTime/ticks << std::setw(14) << result.hits << std::endl;
+    }
+
+    bool valid = true;
+
+    auto checkHits = [&valid] (const std::vector<BenchmarkResult>& results) {
+        for (const BenchmarkResult& result : results) {
+            if (result.hits != results.front().hits) {
+                std::cout << std::endl << "Error - " << result.name << " found a different amount of hits" << std::endl;
+                valid = false;
+            }
+        }
+    };
+
+    checkHits(results);
+    checkHits(queryResults);
+    checkHits(firstHitResults);
+
+    return valid ? 0 : 1;
+}
@@ -0,0 +1,183 @@
+#include <SFML/System/Clock.hpp>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cstdlib>
+
+#include "../include/defines.hpp"
+#include "../include/packet.hpp"
+
+//Throughput of the different ways of packing data into a Packet
+//Usage: mandarina_benchmark_packet [values] [iterations]
+
+struct Field {
+    u32 uniqueId;
+    u8 health;
+    u8 flags;
+    u16 counter;
+};
+
+struct BenchmarkResult {
+    std::string name;
+    sf::Int64 writeTime = 0;
+    sf::Int64 readTime = 0;
+    size_t size = 0;
+    bool valid = true;
+};
+
+//every field byte aligned
+void writeAligned(Packet& packet, const Field& field)
+{
+    packet << field.uniqueId << field.health << field.flags << field.counter;
+}
+
+void readAligned(Packet& packet, Field& field)
+{
+    packet >> field.uniqueId >> field.health >> field.flags >> field.counter;
+}
+
+//health as a 7 bit percentage, 5 bit flags and 12 bit counter
+void writeBits(Packet& packet, const Field& field)
+{
+    packet << field.uniqueId;
+    packet.writeBits(field.health, 7);
+    packet.writeBits(field.flags, 5);
+    packet.writeBits(field.counter, 12);
+}
+
+void readBits(Packet& packet, Field& field)
+{
+    u32 value;
+
+    packet >> field.uniqueId;
+
+    packet.readBits(value, 7);
+    field.health = value;
+
+    packet.readBits(value, 5);
+    field.flags = value;
+
+    packet.readBits(value, 12);
+    field.counter = value;
+}
+
+//same as writeBits but the uniqueId is a variable-length integer
+void writeVarInts(Packet& packet, const Field& field)
+{
+    packet.writeVarUint(field.uniqueId);
+    packet.writeBits(field.health, 7);
+    packet.writeBits(field.flags, 5);
+    packet.writeBits(field.counter, 12);
+}
+
+void readVarInts(Packet& packet, Field& field)
+{
+    u32 value;
+
+    packet.readVarUint(field.uniqueId);
+
+    packet.readBits(value, 7);
+    field.health = value;
+
+    packet.readBits(value, 5);
+    field.flags = value;
+
+    packet.readBits(value, 12);
+    field.counter = value;
+}
+
+bool Field_equals(const Field& lhs, const Field& rhs)
+{
+    return lhs.uniqueId == rhs.uniqueId && lhs.health == rhs.health && lhs.flags == rhs.flags && lhs.counter == rhs.counter;
+}
+
+template <typename WriteFunc, typename ReadFunc>
+BenchmarkResult runBenchmark(const std::string& name, const std::vector<Field>& fields, int iterations, WriteFunc write, ReadFunc read)
+{
+    BenchmarkResult result;
+    result.name = name;
+
+    Packet packet;
+    std::vector<Field> received(fields.size());
+    sf::Clock clock;
+
+    for (int i = 0; i < iterations; ++i) {
+        packet.clear();
+
+        clock.restart();
+
+        for (const Field& field : fields) {
+            write(packet, field);
+        }
+
+        result.writeTime += clock.restart().asMicroseconds();
+
+        for (Field& field : received) {
+            read(packet, field);
+        }
+
+        result.readTime += clock.restart().asMicroseconds();
+    }
+
+    result.size = packet.getDataSize();
+
+    for (size_t i = 0; i < fields.size(); ++i) {
+        result.valid = result.valid && Field_equals(fields[i], received[i]);
+    }
+
+    return result;
+}
+
+void printResult(const BenchmarkResult& result, size_t valueCount, int iterations)
+{
+    //megabytes of the aligned representation processed per second
+    auto throughput = [&] (sf::Int64 time) -> double {
+        const double bytes = static_cast<double>(valueCount * sizeof(Field)) * iterations;
+        return time > 0 ? bytes/static_cast<double>(time) : 0.0;
+    };
+
+    std::cout << std::left << std::setw(12) << result.name << std::right
+              << std::setw(12) << result.size
+              << std::setw(14) << std::fixed << std::setprecision(1) << throughput(result.writeTime)
+              << std::setw(14) << throughput(result.readTime)
+              << std::setw(8) << (result.valid ? "ok" : "FAIL") << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t valueCount = 1000;
+    int iterations = 2000;
+
+    if (argc > 1) valueCount = std::atoi(argv[1]);
+    if (argc > 2) iterations = std::atoi(argv[2]);
+
+    srand(1);
+
+    //values similar to the ones in a snapshot
+    std::vector<Field> fields(valueCount);
+
+    for (Field& field : fields) {
+        field.uniqueId = rand() % 5000;
+        field.health = rand() % 101;
+        field.flags = rand() % 32;
+        field.counter = rand() % 4096;
+    }
+
+    std::vector<BenchmarkResult> results;
+    results.push_back(runBenchmark("aligned", fields, iterations, writeAligned, readAligned));
+    results.push_back(runBenchmark("bits", fields, iterations, writeBits, readBits));
+    results.push_back(runBenchmark("varints", fields, iterations, writeVarInts, readVarInts));
+
+    std::cout << "Values: " << valueCount << " - Iterations: " << iterations << std::endl << std::endl;
+
+    std::cout << std::left << std::setw(12) << "mode" << std::right
+              << std::setw(12) << "bytes" << std::setw(14) << "write MB/s"
+              << std::setw(14) << "read MB/s" << std::setw(8) << "check" << std::endl;
+
+    for (const BenchmarkResult& result : results) {
+        printResult(result, valueCount, iterations);
+    }
+
+    return 0;
+}
@@ -0,0 +1,268 @@
+#include <SFML/System/Clock.hpp>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <cstdlib>
+
+#include "server_entity_manager.hpp"
+#include "collision_manager.hpp"
+#include "tilemap.hpp"
+#include "game_mode.hpp"
+#include "json_parser.hpp"
+#include "weapon.hpp"
+#include "status.hpp"
+#include "hero.hpp"
+#include "entity_pool.hpp"
+
+//Headless benchmark of EntityManager::update (no window or sockets are created)
+//Usage: mandarina_benchmark_tick [map] [ticks] [heroes] [crates] [food] [projectiles] [quadtree|grid]
+//It has to be run from tests/build, like the rest of the tests
+
+const std::string BENCH_JSON_PATH = "../../data/json";
+const std::string BENCH_MAPS_PATH = "../../data/maps/";
+
+//vision is stored with one bit per team (u64), and team 0 is neutral
+constexpr int BENCH_MAX_TEAM_ID = 63;
+
+struct BenchmarkSettings {
+    std::string mapFilename = "ffa_small";
+    int ticks = 2000;
+    int heroes = 50;
+    int crates = 100;
+    int food = 300;
+    int projectiles = 500;
+
+    //empty uses the broadphase of the server config
+    std::string broadphase;
+
+    float updateRate = 30.f;
+};
+
+struct PhaseSamples {
+    std::string name;
+    std::vector<sf::Int64> samples;
+};
+
+Vector2 getRandomFreePosition(const TileMap& tileMap, float radius)
+{
+    const Vector2u worldSize = tileMap.getWorldSize();
+    Vector2 pos;
+
+    //give up after a few tries (the map might be almost full of walls)
+    for (int i = 0; i < 100; ++i) {
+        pos.x = radius + static_cast<float>(rand() % std::max(1, (int) (worldSize.x - 2 * radius)));
+        pos.y = radius + static_cast<float>(rand() % std::max(1, (int) (worldSize.y - 2 * radius)));
+
+        if (!tileMap.isColliding(TILE_BLOCK | TILE_WALL, Circlef(pos, radius))) break;
+    }
+
+    return pos;
+}
+
+void spawnProjectiles(EntityManager& entityManager, const TileMap& tileMap, int target, u8 maxTeamId)
+{
+    while (entityManager.projectiles.firstInvalidIndex() < std::min(target, (int) MAX_PROJECTILES)) {
+        const u8 type = rand() % PROJECTILE_MAX_TYPES;
+        const float aimAngle = static_cast<float>(rand() % 360);
+
+        entityManager.createProjectile(type, getRandomFreePosition(tileMap, 10.f), aimAngle, rand() % maxTeamId + 1);
+    }
+}
+
+void applyRandomInputs(EntityManager& entityManager, const ManagersContext& context, const std::vector<u32>& heroes, sf::Time eTime)
+{
+    PlayerInput input;
+
+    for (u32 uniqueId : heroes) {
+        Unit* unit = static_cast<Unit*>(entityManager.entities.atUniqueId(uniqueId));
+
+        //dead heroes are removed from the table
+        if (!unit) continue;
+
+        input.left = (rand() % 2 == 0);
+        input.right = !input.left && (rand() % 2 == 0);
+        input.up = (rand() % 2 == 0);
+        input.down = !input.up && (rand() % 2 == 0);
+
+        input.primaryFire = (rand() % 4 == 0);
+        input.secondaryFire = (rand() % 50 == 0);
+        input.altAbility = (rand() % 80 == 0);
+        input.ultimate = (rand() % 200 == 0);
+
+        input.aimAngle = static_cast<float>(rand() % 360);
+        input.timeApplied = eTime;
+
+        unit->applyInput(input, context, 0);
+    }
+}
+
+void printPercentiles(PhaseSamples& phase)
+{
+    std::vector<sf::Int64>& samples = phase.samples;
+
+    if (samples.empty()) return;
+
+    std::sort(samples.begin(), samples.end());
+
+    auto percentile = [&samples] (double p) -> sf::Int64 {
+        size_t index = static_cast<size_t>(p * (samples.size() - 1) + 0.5);
+        return samples[index];
+    };
+
+    sf::Int64 total = 0;
+    for (sf::Int64 sample : samples) total += sample;
+
+    std::cout << std::left << std::setw(14) << phase.name << std::right
+              << std::setw(10) << total/(sf::Int64) samples.size()
+              << std::setw(10) << percentile(0.5)
+              << std::setw(10) << percentile(0.9)
+              << std::setw(10) << percentile(0.99)
+              << std::setw(10) << samples.back() << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    BenchmarkSettings settings;
+
+    if (argc > 1) settings.mapFilename = argv[1];
+    if (argc > 2) settings.ticks = std::atoi(argv[2]);
+    if (argc > 3) settings.heroes = std::atoi(argv[3]);
+    if (argc > 4) settings.crates = std::atoi(argv[4]);
+    if (argc > 5) settings.food = std::atoi(argv[5]);
+    if (argc > 6) settings.projectiles = std::atoi(argv[6]);
+    if (argc > 7) settings.broadphase = argv[7];
+
+    if (settings.heroes > BENCH_MAX_TEAM_ID) {
+        std::cout << "There are only " << BENCH_MAX_TEAM_ID << " teams, some heroes will share a team" << std::endl;
+    }
+
+    //same sequence every run so results can be compared
+    srand(1);
+
+    JsonParser jsonParser;
+    jsonParser.loadAll(BENCH_JSON_PATH);
+
+    loadWeaponsFromJson(&jsonParser);
+    loadProjectilesFromJson(&jsonParser);
+
+    CasterComponent::loadAbilityData(&jsonParser);
+    BuffHolderComponent::loadBuffData(&jsonParser);
+    Status::loadJsonData(&jsonParser);
+
+    const rapidjson::Document& serverConfig = *jsonParser.getDocument("server_config");
+
+    if (serverConfig.HasMember("update_rate")) {
+        settings.updateRate = serverConfig["update_rate"].GetFloat();
+    }
+
+    TileMap tileMap;
+    tileMap.loadFromFile(settings.mapFilename, BENCH_MAPS_PATH);
+
+    //the base game mode is used so that no storm or win condition interferes with the results
+    GameMode gameMode;
+    gameMode.loadFromJson(*jsonParser.getDocument("battle_royale_ffa"));
+    gameMode.setTileMap(&tileMap);
+    gameMode.startGame();
+
+    CollisionManager collisionManager;
+    collisionManager.loadFromJson(serverConfig);
+
+    if (settings.broadphase == "grid") {
+        collisionManager.setBroadphaseType(BROADPHASE_UNIFORM_GRID);
+    } else if (settings.broadphase == "quadtree") {
+        collisionManager.setBroadphaseType(BROADPHASE_QUADTREE);
+    }
+
+    collisionManager.setWorldSize(tileMap.getWorldSize());
+
+    EntityManager entityManager(&jsonParser);
+    entityManager.setManagersContext(ManagersContext(nullptr, &collisionManager, &tileMap, &gameMode));
+    entityManager.setWorldSize(tileMap.getWorldSize());
+    entityManager.allocateAll();
+
+    ManagersContext context(&entityManager, &collisionManager, &tileMap, &gameMode);
+
+    std::vector<u32> heroes;
+
+    for (int i = 0; i < settings.heroes; ++i) {
+        const u8 heroType = ENTITY_RED_DEMON + rand() % (ENTITY_FISH_OGRE - ENTITY_RED_DEMON + 1);
+
+        //each hero is in its own team so they can damage each other
+        //(if there are more heroes than teams some of them share a team)
+        Entity* entity = entityManager.createEntity(heroType, getRandomFreePosition(tileMap, 40.f), i % BENCH_MAX_TEAM_ID + 1);
+
+        if (entity) {
+            static_cast<Hero*>(entity)->setDisplayName("bot_" + std::to_string(i));
+            heroes.push_back(entity->getUniqueId());
+        }
+    }
+
+    for (int i = 0; i < settings.crates; ++i) {
+        entityManager.createEntity(ENTITY_NORMAL_CRATE, getRandomFreePosition(tileMap, 40.f), 0);
+    }
+
+    for (int i = 0; i < settings.food; ++i) {
+        entityManager.createEntity(ENTITY_FOOD, getRandomFreePosition(tileMap, 10.f), 0);
+    }
+
+    const u8 maxTeamId = std::min(std::max(1, settings.heroes), BENCH_MAX_TEAM_ID);
+    const sf::Time eTime = sf::seconds(1.f/settings.updateRate);
+
+    PhaseSamples input{"input", {}};
+    PhaseSamples preUpdate{"preUpdate", {}};
+    PhaseSamples update{"update", {}};
+    PhaseSamples projectiles{"projectiles", {}};
+    PhaseSamples postUpdate{"postUpdate", {}};
+    PhaseSamples total{"total", {}};
+
+    std::vector<PhaseSamples*> phases = {&input, &preUpdate, &update, &projectiles, &postUpdate, &total};
+
+    for (PhaseSamples* phase : phases) {
+        phase->samples.reserve(settings.ticks);
+    }
+
+    EntityManager::UpdateTimings timings;
+    sf::Clock clock;
+
+    for (int tick = 0; tick < settings.ticks; ++tick) {
+        //keep the amount of projectiles roughly constant (not measured)
+        spawnProjectiles(entityManager, tileMap, settings.projectiles, maxTeamId);
+
+        clock.restart();
+        applyRandomInputs(entityManager, context, heroes, eTime);
+        input.samples.push_back(clock.restart().asMicroseconds());
+
+        entityManager.update(eTime, &timings);
+
+        preUpdate.samples.push_back(timings.preUpdate.asMicroseconds());
+        update.samples.push_back(timings.update.asMicroseconds());
+        projectiles.samples.push_back(timings.projectiles.asMicroseconds());
+        postUpdate.samples.push_back(timings.postUpdate.asMicroseconds());
+
+        total.samples.push_back(input.samples.back() + (timings.preUpdate + timings.update +
+                                timings.projectiles + timings.postUpdate).asMicroseconds());
+    }
+
+    std::cout << "Map: " << settings.mapFilename << " - Ticks: " << settings.ticks << " at " << settings.updateRate << " Hz" << std::endl;
+    std::cout << "Spawned " << settings.heroes << " heroes, " << settings.crates << " crates, "
+              << settings.food << " food, " << settings.projectiles << " projectiles" << std::endl;
+    std::cout << "Remaining " << entityManager.entities.size() << " entities, "
+              << entityManager.projectiles.firstInvalidIndex() << " projectiles" << std::endl;
+    std::cout << "Broadphase: " << (collisionManager.getBroadphaseType() == BROADPHASE_UNIFORM_GRID ? "grid" : "quadtree") << std::endl;
+    std::cout << "Tick budget: " << eTime.asMicroseconds() << " us" << std::endl << std::endl;
+
+    std::cout << std::left << std::setw(14) << "phase (us)" << std::right
+              << std::setw(10) << "mean" << std::setw(10) << "p50" << std::setw(10) << "p90"
+              << std::setw(10) << "p99" << std::setw(10) << "max" << std::endl;
+
+    for (PhaseSamples* phase : phases) {
+        printPercentiles(*phase);
+    }
+
+    std::cout << std::endl;
+    EntityPool_printStats(false);
+
+    return 0;
+}
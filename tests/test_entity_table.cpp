@@ -0,0 +1,192 @@
+#include "../include/defines.hpp"
+#include "../include/entity_table.hpp"
+#include "../include/flat_index.hpp"
+#include "../include/bucket.hpp"
+#include <unordered_map>
+#include <algorithm>
+#include <iostream>
+
+#define ASSERT(CONDITION) if (!(CONDITION)) {\
+        printf("Assertion failure %s:%d ASSERT(%s)\n", __FILE__, __LINE__, #CONDITION);\
+    }
+
+struct TestEntity {
+    TestEntity(u32 id) : uniqueId(id) {}
+    u32 getUniqueId() const {return uniqueId;}
+
+    u32 uniqueId;
+};
+
+void check_flat_index(int N)
+{
+    FlatIndex index;
+    std::unordered_map<u32, u32> reference;
+
+    ASSERT(!index.insert(0, 1))
+
+    for (int i = 0; i < N; ++i) {
+        u32 key = rand() % (N * 2) + 1;
+
+        if (rand() % 3 == 0) {
+            ASSERT(index.erase(key) == (reference.erase(key) == 1))
+        } else {
+            ASSERT(index.insert(key, i) == reference.emplace(key, i).second)
+        }
+    }
+
+    ASSERT(index.size() == reference.size())
+
+    for (u32 key = 1; key <= (u32) N * 2; ++key) {
+        const u32* value = index.find(key);
+        auto it = reference.find(key);
+
+        ASSERT((value != nullptr) == (it != reference.end()))
+
+        if (value && it != reference.end()) {
+            ASSERT(*value == it->second)
+        }
+    }
+
+    index.clear();
+    ASSERT(index.size() == 0)
+    ASSERT(!index.find(1))
+}
+
+//chunk keys have most of their bits in the high half
+void check_flat_index64(int N)
+{
+    FlatIndex64 index;
+    std::unordered_map<u64, u32> reference;
+
+    for (int i = 0; i < N; ++i) {
+        u64 key = (static_cast<u64>(rand() % N + 1) << 32) | (rand() % 4);
+
+        if (rand() % 3 == 0) {
+            ASSERT(index.erase(key) == (reference.erase(key) == 1))
+        } else {
+            ASSERT(index.insert(key, i) == reference.emplace(key, i).second)
+        }
+    }
+
+    ASSERT(index.size() == reference.size())
+
+    for (const auto& pair : reference) {
+        const u32* value = index.find(pair.first);
+        ASSERT(value && *value == pair.second)
+    }
+
+    ASSERT(!index.find(1))
+}
+
+void check_entity_table(int N)
+{
+    EntityTable<TestEntity> table;
+
+    for (int i = 1; i <= N; ++i) {
+        ASSERT(table.addEntity(new TestEntity(i)))
+    }
+
+    //repeated uniqueIds are not added
+    TestEntity* repeated = new TestEntity(1);
+    ASSERT(!table.addEntity(repeated))
+    delete repeated;
+
+    EntityHandle handle = table.getHandle(N);
+    ASSERT(table.atHandle(handle) == table.atUniqueId(N))
+
+    //remove the even entities while iterating
+    for (auto it = table.begin(); it != table.end();) {
+        if (it->getUniqueId() % 2 == 0) {
+            it = table.removeEntity(it);
+        } else {
+            ++it;
+        }
+    }
+
+    ASSERT(table.size() == (size_t) (N + 1)/2)
+
+    for (int i = 1; i <= N; ++i) {
+        ASSERT((table.atUniqueId(i) != nullptr) == (i % 2 == 1))
+    }
+
+    //all the remaining entities are visited once
+    std::vector<u32> visited;
+
+    for (auto it = table.begin(); it != table.end(); ++it) {
+        visited.push_back(it->getUniqueId());
+    }
+
+    std::sort(visited.begin(), visited.end());
+    ASSERT(std::unique(visited.begin(), visited.end()) == visited.end())
+    ASSERT(visited.size() == table.size())
+
+    //handles of removed entities stay invalid after their slot is reused
+    EntityHandle evenHandle = table.getHandle(1);
+    table.removeEntity(1);
+    ASSERT(!table.atHandle(evenHandle))
+
+    table.addEntity(new TestEntity(N + 1));
+    ASSERT(!table.atHandle(evenHandle))
+    ASSERT(table.atHandle(table.getHandle(N + 1))->getUniqueId() == (u32) N + 1)
+
+    table.clear();
+    ASSERT(table.size() == 0)
+    ASSERT(table.begin() == table.end())
+}
+
+struct TestElement {
+    u32 uniqueId = 0;
+    int value = 0;
+};
+
+void check_bucket(int N)
+{
+    Bucket<TestElement> bucket;
+
+    ASSERT(bucket.addElement(0) == -1)
+
+    for (int i = 1; i <= N; ++i) {
+        int index = bucket.addElement(i);
+        bucket[index].uniqueId = i;
+        bucket[index].value = i * 3;
+    }
+
+    ASSERT(bucket.addElement(1) == -1)
+
+    //the last element is moved to the place of the removed one
+    for (int i = 1; i <= N; i += 3) {
+        bucket.removeElement(i);
+    }
+
+    Bucket<TestElement> copy;
+    copy.addElement(N + 1);
+    bucket.copyValidDataTo(copy);
+
+    ASSERT(copy.firstInvalidIndex() == bucket.firstInvalidIndex())
+    ASSERT(!copy.atUniqueId(N + 1))
+
+    for (int i = 1; i <= N; ++i) {
+        const TestElement* element = copy.atUniqueId(i);
+
+        ASSERT((element != nullptr) == (i % 3 != 1))
+
+        if (element) {
+            ASSERT(element->uniqueId == (u32) i && element->value == i * 3)
+        }
+    }
+}
+
+int main()
+{
+    srand(time(0));
+
+    check_flat_index(100);
+    check_flat_index(10000);
+    check_flat_index64(10000);
+
+    check_entity_table(10);
+    check_entity_table(1001);
+
+    check_bucket(10);
+    check_bucket(2000);
+}
@@ -0,0 +1,95 @@
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <string>
+
+#include "server_entity_manager.hpp"
+#include "collision_manager.hpp"
+#include "tilemap.hpp"
+#include "game_mode.hpp"
+#include "json_parser.hpp"
+#include "weapon.hpp"
+#include "status.hpp"
+
+#define ASSERT(CONDITION) if (!(CONDITION)) {\
+        printf("Assertion failure %s:%d ASSERT(%s)\n", __FILE__, __LINE__, #CONDITION);\
+    }
+
+//It has to be run from tests/build, like the rest of the tests
+
+const std::string TEST_JSON_PATH = "../../data/json";
+const std::string TEST_MAPS_PATH = "../../data/maps/";
+
+bool contains(const std::vector<u32>& uniqueIds, u32 uniqueId)
+{
+    return std::find(uniqueIds.begin(), uniqueIds.end(), uniqueId) != uniqueIds.end();
+}
+
+//entities that are not in the broadphase (like food) have to be sent too
+void check_interest_entities(const JsonParser& jsonParser)
+{
+    TileMap tileMap;
+    tileMap.loadFromFile("ffa_small", TEST_MAPS_PATH);
+
+    GameMode gameMode;
+    gameMode.loadFromJson(*jsonParser.getDocument("battle_royale_ffa"));
+    gameMode.setTileMap(&tileMap);
+
+    CollisionManager collisionManager;
+    collisionManager.setWorldSize(tileMap.getWorldSize());
+
+    EntityManager entityManager(&jsonParser);
+    entityManager.setManagersContext(ManagersContext(nullptr, &collisionManager, &tileMap, &gameMode));
+    entityManager.setWorldSize(tileMap.getWorldSize());
+    entityManager.allocateAll();
+
+    Entity* food = entityManager.createEntity(ENTITY_FOOD, Vector2(300.f, 300.f), 0);
+    Entity* crate = entityManager.createEntity(ENTITY_NORMAL_CRATE, Vector2(400.f, 300.f), 0);
+    Entity* farFood = entityManager.createEntity(ENTITY_FOOD, Vector2(1500.f, 1500.f), 0);
+
+    ASSERT(food && crate && farFood)
+    if (!food || !crate || !farFood) return;
+
+    ASSERT(!food->isSolid())
+    ASSERT(crate->isSolid())
+
+    //food is kept in its own grid, out of the collision broadphase
+    ASSERT(food->getBroadphaseProxy()->collisionManager != nullptr)
+    ASSERT(food->getBroadphaseProxy()->collisionManager != &collisionManager)
+
+    std::vector<u32> uniqueIds;
+    entityManager.queryInterestEntities(sf::FloatRect(0.f, 0.f, 800.f, 600.f), 1, uniqueIds);
+
+    ASSERT(contains(uniqueIds, food->getUniqueId()))
+    ASSERT(contains(uniqueIds, crate->getUniqueId()))
+    ASSERT(!contains(uniqueIds, farFood->getUniqueId()))
+
+    //the whole world (interest management disabled)
+    const Vector2u worldSize = tileMap.getWorldSize();
+    entityManager.queryInterestEntities(sf::FloatRect(0.f, 0.f, worldSize.x, worldSize.y), 1, uniqueIds);
+
+    ASSERT(uniqueIds.size() == 3)
+
+    //entities are removed from the grid when they're destroyed
+    entityManager.entities.clear();
+    entityManager.queryInterestEntities(sf::FloatRect(0.f, 0.f, worldSize.x, worldSize.y), 1, uniqueIds);
+
+    ASSERT(uniqueIds.empty())
+}
+
+int main()
+{
+    JsonParser jsonParser;
+    jsonParser.loadAll(TEST_JSON_PATH);
+
+    loadWeaponsFromJson(&jsonParser);
+    loadProjectilesFromJson(&jsonParser);
+
+    CasterComponent::loadAbilityData(&jsonParser);
+    BuffHolderComponent::loadBuffData(&jsonParser);
+    Status::loadJsonData(&jsonParser);
+
+    check_interest_entities(jsonParser);
+
+    return 0;
+}
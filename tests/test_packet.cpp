@@ -1,5 +1,8 @@
 #include "../include/defines.hpp"
 #include "../include/packet.hpp"
+#include "../include/quantize.hpp"
+#include <cmath>
+#include <algorithm>
 #include <iostream>
 
 #define ASSERT(CONDITION) if (!(CONDITION)) {\
@@ -108,6 +111,214 @@ void simple_size_test()
     std::cout << packet.getDataSize() << std::endl;
 }
 
+void check_bits(int N)
+{
+    Packet packet;
+
+    std::vector<std::pair<u32, size_t>> sent;
+
+    for (int i = 0; i < N; ++i) {
+        size_t bitCount = rand() % 32 + 1;
+        u32 value = static_cast<u32>(rand()) & (bitCount == 32 ? 0xffffffff : (1u << bitCount) - 1);
+
+        packet.writeBits(value, bitCount);
+        sent.emplace_back(value, bitCount);
+    }
+
+    for (int i = 0; i < N; ++i) {
+        u32 value;
+        packet.readBits(value, sent[i].second);
+
+        ASSERT(value == sent[i].first)
+    }
+
+    ASSERT(packet.endOfPacket())
+}
+
+void check_bits_mixed()
+{
+    Packet packet;
+    bool a;
+    u8 byte;
+    u32 value;
+
+    //7 bit percentage and 5 bit flags packed with bools in 2 bytes
+    packet << true;
+    packet.writeBits(100, 7);
+    packet.writeBits(0b10110, 5);
+    packet << false << true;
+
+    ASSERT(packet.getDataSize() == 2)
+
+    //byte aligned values start a new byte
+    packet << (u8) 137;
+    packet.writeBits(5, 3);
+
+    ASSERT(packet.getDataSize() == 4)
+
+    packet >> a;
+    ASSERT(a)
+
+    packet.readBits(value, 7);
+    ASSERT(value == 100)
+
+    packet.readBits(value, 5);
+    ASSERT(value == 0b10110)
+
+    packet >> a;
+    ASSERT(!a)
+
+    packet >> a;
+    ASSERT(a)
+
+    packet >> byte;
+    ASSERT(byte == 137)
+
+    packet.readBits(value, 3);
+    ASSERT(value == 5)
+
+    ASSERT(packet.endOfPacket())
+}
+
+void check_var_ints()
+{
+    Packet packet;
+
+    const std::vector<u32> unsignedValues = {0, 1, 127, 128, 300, 16383, 16384, 0xfffff, 0xffffffff};
+    const std::vector<s32> signedValues = {0, -1, 1, -64, 63, -65, 1000, -100000, 2147483647, -2147483647 - 1};
+
+    //start unaligned to check groups can cross bytes
+    packet << true;
+
+    for (u32 value : unsignedValues) {
+        packet.writeVarUint(value);
+    }
+
+    for (s32 value : signedValues) {
+        packet.writeVarInt(value);
+    }
+
+    bool a;
+    packet >> a;
+    ASSERT(a)
+
+    for (u32 value : unsignedValues) {
+        u32 received;
+        packet.readVarUint(received);
+
+        ASSERT(received == value)
+    }
+
+    for (s32 value : signedValues) {
+        s32 received;
+        packet.readVarInt(received);
+
+        ASSERT(received == value)
+    }
+
+    ASSERT(packet.endOfPacket())
+
+    //small values only use 1 byte
+    Packet small;
+    small.writeVarUint(127);
+    ASSERT(small.getDataSize() == 1)
+
+    small.clear();
+    small.writeVarInt(-64);
+    ASSERT(small.getDataSize() == 1)
+}
+
+void check_bits_invalid()
+{
+    Packet packet;
+    u32 value;
+
+    packet.writeBits(3, 2);
+
+    packet.readBits(value, 8);
+    ASSERT(value == 3)
+
+    //reading past the end invalidates the packet
+    packet.readBits(value, 8);
+    ASSERT(!packet)
+}
+
+void check_append_chunks(int N)
+{
+    Packet packet;
+    Packet chunk;
+
+    packet << (u16) N;
+
+    //each chunk ends in the middle of a byte
+    for (int i = 0; i < N; ++i) {
+        chunk.clear();
+        chunk.writeVarUint(i * 37);
+        chunk << (i % 2 == 0);
+
+        packet.append(chunk.getData(), chunk.getDataSize());
+    }
+
+    u16 count;
+    packet >> count;
+    ASSERT(count == N)
+
+    for (int i = 0; i < N; ++i) {
+        packet.alignRead();
+
+        u32 value;
+        bool a;
+        packet.readVarUint(value);
+        packet >> a;
+
+        ASSERT(value == (u32) i * 37)
+        ASSERT(a == (i % 2 == 0))
+    }
+
+    ASSERT(packet.endOfPacket())
+}
+
+void check_quantize(u32 worldSize, float precision)
+{
+    CRCPacket packet;
+
+    //the client starts with the value of the entity before it's loaded
+    float received = 0.f;
+    float prevSent = 0.f;
+
+    for (int i = 0; i < 100; ++i) {
+        //mix small and big changes
+        float sent = (i % 10 == 0) ? static_cast<float>(rand() % worldSize) : prevSent + static_cast<float>(rand() % 21 - 10) * 0.3f;
+        sent = std::max(sent, 0.f);
+
+        QuantizedCoord coord = Quantize_coord(sent, i == 0 ? nullptr : &prevSent, precision);
+
+        packet.clear();
+        packet << coord.changed << coord.isDelta;
+
+        if (coord.changed) {
+            Quantize_packCoord(coord, worldSize, precision, packet);
+        }
+
+        bool changed, isDelta;
+        packet >> changed >> isDelta;
+
+        if (changed) {
+            Quantize_loadCoord(received, isDelta, worldSize, precision, packet);
+        }
+
+        ASSERT(packet.endOfPacket())
+        ASSERT(std::abs(received - sent) <= precision/2.f + 0.001f)
+
+        //deltas only use 1 byte
+        if (coord.isDelta) {
+            ASSERT(packet.getDataSize() == 2)
+        }
+
+        prevSent = sent;
+    }
+}
+
 int main()
 {
     srand(time(0));
@@ -121,4 +332,14 @@ int main()
     check_string();
 
     simple_size_test();
+
+    check_bits(10);
+    check_bits(1000);
+    check_bits_mixed();
+    check_var_ints();
+    check_bits_invalid();
+    check_append_chunks(100);
+
+    check_quantize(2048, 0.125f);
+    check_quantize(100000, 0.25f);
 }
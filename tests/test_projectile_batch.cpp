@@ -0,0 +1,321 @@
+#include "../include/defines.hpp"
+#include "../include/projectile_batch.hpp"
+#include "../include/collision_manager.hpp"
+#include "../include/lag_compensation.hpp"
+#include "../include/helper.hpp"
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+
+#define ASSERT(CONDITION) if (!(CONDITION)) {\
+        printf("Assertion failure %s:%d ASSERT(%s)\n", __FILE__, __LINE__, #CONDITION);\
+    }
+
+float randomFloat(float max)
+{
+    return static_cast<float>(rand())/static_cast<float>(RAND_MAX) * max;
+}
+
+//the batch has to move projectiles the same way Projectile_update does
+void check_projectile_batch(int N, int steps)
+{
+    Bucket<Projectile> projectiles(N);
+    std::vector<Projectile> expected;
+
+    for (int i = 1; i <= N; ++i) {
+        Projectile& projectile = projectiles[projectiles.addElement(i)];
+
+        const float angle = randomFloat(2.f * PI);
+
+        projectile.uniqueId = i;
+        projectile.pos = Vector2(randomFloat(1000.f), rand() % 1000);
+        projectile.movementSpeed = rand() % 1500;
+        projectile.vel = Vector2(std::sin(angle), std::cos(angle)) * (float) projectile.movementSpeed;
+        projectile.range = (i % 4 == 0 ? 0.f : rand() % 1000);
+        projectile.distanceTraveled = 0.f;
+        projectile.dead = (i % 7 == 0);
+
+        expected.push_back(projectile);
+    }
+
+    ProjectileBatch batch;
+    const float eTime = 1.f/60.f;
+
+    for (int step = 0; step < steps; ++step) {
+        ProjectileBatch_gather(batch, projectiles);
+        ProjectileBatch_integrate(batch, eTime);
+        ProjectileBatch_scatter(batch, projectiles);
+
+        for (Projectile& projectile : expected) {
+            if (projectile.dead) continue;
+
+            if (projectile.range != 0 && projectile.distanceTraveled > projectile.range) {
+                projectile.dead = true;
+                continue;
+            }
+
+            Vector2 moveVec = projectile.vel * eTime;
+            projectile.pos += moveVec;
+            projectile.distanceTraveled += Helper_vec2length(moveVec);
+        }
+    }
+
+    ASSERT(batch.count == (size_t) N)
+
+    for (int i = 0; i < N; ++i) {
+        const Projectile& projectile = projectiles[i];
+        const Projectile& reference = expected[i];
+
+        //the batch doesn't compute the length of the movement, so a projectile that travels
+        //exactly its range might expire one update earlier or later because of rounding
+        if (reference.range != 0 && std::min(std::abs(projectile.distanceTraveled - reference.range), std::abs(reference.distanceTraveled - reference.range)) < 0.01f) continue;
+
+        ASSERT(projectile.dead == reference.dead)
+        ASSERT(std::abs(projectile.pos.x - reference.pos.x) < 0.01f)
+        ASSERT(std::abs(projectile.pos.y - reference.pos.y) < 0.01f)
+        ASSERT(std::abs(projectile.distanceTraveled - reference.distanceTraveled) < 0.01f)
+    }
+}
+
+//reference for the broadphase queries: every unit is checked
+//returns the earliest time the projectile hits any unit (or -1 if it doesn't hit any)
+float findFirstHitTime(const Projectile& projectile, const Vector2& start, const std::vector<BroadphaseProxy>& units)
+{
+    const Circlef circle(start, projectile.collisionRadius);
+    float firstTime = -1.f;
+
+    for (const BroadphaseProxy& unit : units) {
+        const bool sameTeam = (unit.teamId == projectile.teamId);
+
+        if (sameTeam && (projectile.hitFlags & HitFlags::Allies) == 0) continue;
+        if (!sameTeam && (projectile.hitFlags & HitFlags::Enemies) == 0) continue;
+
+        float time;
+
+        if (circle.sweepIntersects(projectile.pos, unit.body.circle, time) && (firstTime < 0.f || time < firstTime)) {
+            firstTime = time;
+        }
+    }
+
+    return firstTime;
+}
+
+//the batched collision pass has to find the first unit each projectile hits
+void check_projectile_hits(int unitCount, int N, BroadphaseType broadphaseType)
+{
+    const float worldSize = 2000.f;
+
+    CollisionManager collisionManager(broadphaseType);
+    collisionManager.setWorldSize(Vector2u(worldSize, worldSize));
+
+    //units only need their proxy here
+    std::vector<BroadphaseProxy> units(unitCount);
+
+    for (int i = 0; i < unitCount; ++i) {
+        units[i].uniqueId = i + 1;
+        units[i].teamId = rand() % 4;
+        units[i].solid = true;
+        units[i].body = BoundingBodyf(Circlef(Vector2(randomFloat(worldSize), randomFloat(worldSize)), 20.f + rand() % 40));
+
+        collisionManager.insertProxy(&units[i]);
+    }
+
+    Bucket<Projectile> projectiles(N);
+
+    const u8 hitFlags[] = {HitFlags::Enemies, HitFlags::Allies, HitFlags::Both, HitFlags::None};
+
+    std::vector<Vector2> startPos;
+
+    for (int i = 1; i <= N; ++i) {
+        Projectile& projectile = projectiles[projectiles.addElement(i)];
+
+        const float angle = randomFloat(2.f * PI);
+
+        projectile.uniqueId = i;
+        projectile.pos = Vector2(randomFloat(worldSize), randomFloat(worldSize));
+        projectile.movementSpeed = rand() % 1500;
+        projectile.vel = Vector2(std::sin(angle), std::cos(angle)) * (float) projectile.movementSpeed;
+        projectile.range = 0;
+        projectile.distanceTraveled = 0.f;
+        projectile.collisionRadius = 5 + rand() % 20;
+        projectile.teamId = rand() % 4;
+        projectile.hitFlags = hitFlags[rand() % 4];
+        projectile.dead = (i % 7 == 0);
+
+        startPos.push_back(projectile.pos);
+    }
+
+    ProjectileBatch batch;
+    ProjectileBatch_gather(batch, projectiles);
+    ProjectileBatch_integrate(batch, 1.f/30.f);
+    ProjectileBatch_scatter(batch, projectiles);
+    ProjectileBatch_findHits(batch, projectiles, collisionManager);
+
+    size_t hitIndex = 0;
+
+    for (int i = 0; i < N; ++i) {
+        const Projectile& projectile = projectiles[i];
+
+        const float expectedTime = (projectile.dead ? -1.f : findFirstHitTime(projectile, startPos[i], units));
+
+        const BroadphaseProxy* hit = nullptr;
+        float time = 0.f;
+
+        if (hitIndex < batch.hits.size() && batch.hits[hitIndex].projectileIndex == (u32) i) {
+            hit = batch.hits[hitIndex].proxy;
+            time = batch.hits[hitIndex].time;
+            hitIndex++;
+        }
+
+        ASSERT((hit != nullptr) == (expectedTime >= 0.f))
+
+        //if several units are hit at the same time any of them is valid
+        if (hit) {
+            float hitTime;
+            const bool sameTeam = (hit->teamId == projectile.teamId);
+
+            ASSERT(time == expectedTime)
+            ASSERT((sameTeam && (projectile.hitFlags & HitFlags::Allies)) || (!sameTeam && (projectile.hitFlags & HitFlags::Enemies)))
+            ASSERT(Circlef(startPos[i], projectile.collisionRadius).sweepIntersects(projectile.pos, hit->body.circle, hitTime) && hitTime == time)
+        }
+    }
+
+    //hits are sorted by projectile and there is at most one per projectile
+    ASSERT(hitIndex == batch.hits.size())
+}
+
+//the swept tests have to find the first contact of the circle moving in small steps
+void check_sweep_intersects(int N)
+{
+    const int steps = 2000;
+
+    for (int n = 0; n < N; ++n) {
+        const Circlef circle(Vector2(randomFloat(500.f), randomFloat(500.f)), 1.f + randomFloat(30.f));
+        const Vector2 end(randomFloat(500.f), randomFloat(500.f));
+
+        const Circlef other(Vector2(randomFloat(500.f), randomFloat(500.f)), 1.f + randomFloat(50.f));
+        const sf::FloatRect rect(randomFloat(450.f), randomFloat(450.f), 1.f + randomFloat(100.f), 1.f + randomFloat(100.f));
+
+        float circleTime = 0.f;
+        float rectTime = 0.f;
+        const bool circleHit = circle.sweepIntersects(end, other, circleTime);
+        const bool rectHit = circle.sweepIntersects(end, rect, rectTime);
+
+        int circleStep = -1;
+        int rectStep = -1;
+
+        for (int i = 0; i <= steps; ++i) {
+            const Circlef moved(circle.center + (end - circle.center) * ((float) i/steps), circle.radius);
+
+            if (circleStep == -1 && moved.intersects(other)) circleStep = i;
+            if (rectStep == -1 && moved.intersects(rect)) rectStep = i;
+        }
+
+        const float tolerance = 1.f/steps + 0.001f;
+
+        //the steps might miss contacts that are very short
+        ASSERT(circleStep == -1 || (circleHit && std::abs(circleTime - (float) circleStep/steps) < tolerance))
+        ASSERT(rectStep == -1 || (rectHit && std::abs(rectTime - (float) rectStep/steps) < tolerance))
+
+        //a bit bigger circle always intersects at the contact
+        const Vector2 movement = end - circle.center;
+        ASSERT(!circleHit || Circlef(circle.center + movement * circleTime, circle.radius + 0.01f).intersects(other))
+        ASSERT(!rectHit || Circlef(circle.center + movement * rectTime, circle.radius + 0.01f).intersects(rect))
+    }
+}
+
+//fast projectiles have to hit small units they go through during a tick
+void check_projectile_tunneling()
+{
+    CollisionManager collisionManager;
+    collisionManager.setWorldSize(Vector2u(1000, 1000));
+
+    BroadphaseProxy unit;
+    unit.uniqueId = 1;
+    unit.teamId = 1;
+    unit.body = BoundingBodyf(Circlef(Vector2(500.f, 500.f), 10.f));
+    collisionManager.insertProxy(&unit);
+
+    Projectile projectile;
+    projectile.teamId = 2;
+    projectile.hitFlags = HitFlags::Enemies;
+    projectile.collisionRadius = 5;
+    projectile.pos = Vector2(600.f, 500.f);
+
+    float time = 0.f;
+    ASSERT(Projectile_findHit(projectile, Vector2(400.f, 500.f), collisionManager, time) == &unit)
+    ASSERT(std::abs(time - 0.425f) < 0.001f)
+
+    //passing next to the unit
+    projectile.pos = Vector2(600.f, 516.f);
+    ASSERT(Projectile_findHit(projectile, Vector2(400.f, 516.f), collisionManager, time) == nullptr)
+}
+
+//lagged hits are checked against the units where they were in the past
+void check_rewound_hits()
+{
+    CollisionManager collisionManager;
+    collisionManager.setWorldSize(Vector2u(1000, 1000));
+
+    LagCompensation lagCompensation(4);
+
+    //moves 100 units down each update
+    BroadphaseProxy unit;
+    unit.uniqueId = 7;
+    unit.teamId = 1;
+    unit.body = BoundingBodyf(Circlef(Vector2(500.f, 0.f), 10.f));
+    collisionManager.insertProxy(&unit);
+
+    for (int i = 0; i <= 5; ++i) {
+        unit.body.circle.center.y = 100.f * i;
+        collisionManager.updateProxy(&unit);
+
+        lagCompensation.record(sf::milliseconds(100 * i), collisionManager);
+    }
+
+    //only the latest 4 updates are stored
+    ASSERT(lagCompensation.getCount() == 4)
+    ASSERT(lagCompensation.getOldestTime() == sf::milliseconds(200))
+    ASSERT(lagCompensation.getLatestTime() == sf::milliseconds(500))
+
+    Projectile projectile;
+    projectile.teamId = 2;
+    projectile.hitFlags = HitFlags::Enemies;
+    projectile.collisionRadius = 5;
+    projectile.pos = Vector2(600.f, 350.f);
+
+    const Vector2 start(400.f, 350.f);
+    float time = 0.f;
+
+    //the unit is at y = 500 now
+    ASSERT(Projectile_findHit(projectile, start, collisionManager, time) == nullptr)
+
+    //and it was at y = 350 (interpolated) at 350 ms
+    ASSERT(Projectile_findRewoundHit(projectile, start, lagCompensation, sf::milliseconds(350), time) == unit.uniqueId)
+    ASSERT(std::abs(time - 0.425f) < 0.001f)
+
+    //at y = 300 or 400 it passes next to it
+    ASSERT(Projectile_findRewoundHit(projectile, start, lagCompensation, sf::milliseconds(300), time) == 0)
+    ASSERT(Projectile_findRewoundHit(projectile, start, lagCompensation, sf::milliseconds(400), time) == 0)
+
+    //times older than the history use the oldest update
+    projectile.pos.y = 200.f;
+    ASSERT(Projectile_findRewoundHit(projectile, Vector2(400.f, 200.f), lagCompensation, sf::milliseconds(0), time) == unit.uniqueId)
+}
+
+int main()
+{
+    srand(time(0));
+
+    check_projectile_batch(1, 10);
+    check_projectile_batch(7, 60);
+    check_projectile_batch(MAX_PROJECTILES, 120);
+
+    check_projectile_hits(0, 50, BROADPHASE_QUADTREE);
+    check_projectile_hits(100, MAX_PROJECTILES, BROADPHASE_QUADTREE);
+    check_projectile_hits(100, MAX_PROJECTILES, BROADPHASE_UNIFORM_GRID);
+
+    check_sweep_intersects(10000);
+    check_projectile_tunneling();
+    check_rewound_hits();
+}
@@ -264,6 +264,71 @@ void rotating_and_circle_test()
     }
 }
 
+//visitor queries have to clean up the tree like the iterator does
+//(empty nodes are deleted and objects deeper than the maximal depth are moved up)
+void quadtree_cleanup_test()
+{
+    using QuadtreeType = Quadtree<float, QuadtreeEntity<float>, SimpleExtractor<float>>;
+    using TestType = std::unique_ptr<QuadtreeEntity<float>>;
+
+    const BoundingBodyf world(sf::FloatRect(0.f, 0.f, 4096.f, 4096.f));
+    auto visitor = [] (QuadtreeEntity<float>* entity) -> bool {return false;};
+
+    //expected is cleaned up with the iterator
+    QuadtreeType quadtree;
+    QuadtreeType expected;
+
+    std::vector<TestType> entities;
+
+    //enough to increase the maximal depth
+    for (int i = 0; i < 1500; ++i) {
+        entities.push_back(TestType(new QuadtreeEntity<float>(i + 1, Circlef(rand() % 4096, rand() % 4096, 2.f))));
+
+        quadtree.Insert(entities.back().get());
+        expected.Insert(entities.back().get());
+    }
+
+    //all of them move to a corner
+    for (TestType& entity : entities) {
+        entity->body.circle.center = Vector2(rand() % 512, rand() % 512);
+
+        quadtree.Update(entity.get());
+        expected.Update(entity.get());
+    }
+
+    //the maximal depth decreases again
+    for (size_t i = 0; i < entities.size(); ++i) {
+        if (i % 3 == 0) continue;
+
+        quadtree.Remove(entities[i].get());
+        expected.Remove(entities[i].get());
+    }
+
+    const int nodesBefore = quadtree.GetNodeCount();
+
+    quadtree.ForEachIntersecting(world, visitor);
+    expected.ForceCleanup();
+
+    ASSERT(quadtree.GetSize() == expected.GetSize());
+    ASSERT(quadtree.GetNodeCount() < nodesBefore);
+    ASSERT(quadtree.GetNodeCount() == expected.GetNodeCount());
+
+    //the same entities are still found
+    std::vector<QuadtreeEntity<float>*> found;
+    quadtree.CollectIntersecting(world, found);
+    ASSERT(found.size() == entities.size()/3);
+
+    //the root is deleted when the tree is empty
+    for (size_t i = 0; i < entities.size(); i += 3) {
+        quadtree.Remove(entities[i].get());
+    }
+
+    quadtree.ForEachIntersecting(world, visitor);
+
+    ASSERT(quadtree.IsEmpty());
+    ASSERT(quadtree.GetNodeCount() == 0);
+}
+
 void food_distribution_test()
 {
     JsonParser json;
@@ -291,6 +356,7 @@ int main()
 {
     // rotating_shape_test();
     //rotating_and_circle_test();
+    quadtree_cleanup_test();
     food_distribution_test();
     return 0;
 }